@@ -182,21 +182,35 @@ def main():
     skip_tasks = ['cocos2d']
     tasks = [x for x in tasks if x not in skip_tasks]
     print('Building targets: %s' % ' '.join(tasks))
-  for what in tasks:
+
+  def rename_legacy(what):
     for old, new in legacy_prefixes.items():
       if what.startswith(old):
         what = what.replace(old, new)
+    return what
+
+  tasks = [rename_legacy(what) for what in tasks]
+
+  # Build all the requested system libraries up front, so that their objects
+  # are all compiled in one parallel batch, instead of one library at a time
+  # below.
+  libraries = [system_libraries[what] for what in tasks if what in system_libraries]
+  if do_clear:
+    for library in libraries:
+      library.erase()
+  if do_build and len(libraries) > 1:
+    logger.info('compiling %d system libraries' % len(libraries))
+    system_libs.build_libraries(libraries)
+
+  for what in tasks:
     if do_build:
       logger.info('building ' + what)
     else:
       logger.info('clearing ' + what)
     start_time = time.time()
     if what in system_libraries:
-      library = system_libraries[what]
-      if do_clear:
-        library.erase()
       if do_build:
-        library.get_path()
+        system_libraries[what].get_path()
     elif what == 'sysroot':
       if do_clear:
         shared.Cache.erase_file('sysroot_install.stamp')
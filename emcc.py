@@ -23,6 +23,7 @@ emcc can be influenced by a few environment variables:
 from tools.toolchain_profiler import ToolchainProfiler
 
 import base64
+import hashlib
 import json
 import logging
 import os
@@ -1492,6 +1493,13 @@ def phase_linker_setup(options, state, newargs, settings_map):
     # Otherwise the wasm file is produced alongside the final target.
     wasm_target = get_secondary_target(target, '.wasm')
 
+  if settings.INCREMENTAL_LINK:
+    settings.LINK_STATE_DIR = os.path.abspath(shared.replace_or_append_suffix(target, '.linkstate'))
+    utils.safe_ensure_dirs(settings.LINK_STATE_DIR)
+
+  if not config.FROZEN_CACHE:
+    settings.JS_LIBRARY_CACHE_DIR = shared.Cache.get_path('js_libraries')
+
   if settings.SAFE_HEAP not in [0, 1, 2]:
     exit_with_error('emcc: SAFE_HEAP must be 0, 1 or 2')
 
@@ -1524,6 +1532,11 @@ def phase_linker_setup(options, state, newargs, settings_map):
     # handling on the FFI boundary, which is exactly like the case of JS with
     # BigInt support
     settings.WASM_BIGINT = 1
+    # the wasm2c we use only translates MVP wasm, so there are no atomics or
+    # shared memory for threads to use, and the runtime has no way to start
+    # them
+    if settings.USE_PTHREADS:
+      exit_with_error('WASM2C does not support pthreads (USE_PTHREADS)')
 
   if options.no_entry:
     settings.EXPECT_MAIN = 0
@@ -2040,6 +2053,10 @@ def phase_linker_setup(options, state, newargs, settings_map):
   elif settings.PROXY_TO_PTHREAD:
     exit_with_error('-s PROXY_TO_PTHREAD=1 requires -s USE_PTHREADS to work!')
 
+  if settings.MAIN_THREAD_ASYNC_WAITS:
+    if not settings.USE_PTHREADS or not settings.ASYNCIFY:
+      exit_with_error('-s MAIN_THREAD_ASYNC_WAITS requires -s USE_PTHREADS and -s ASYNCIFY')
+
   def check_memory_setting(setting):
     if settings[setting] % webassembly.WASM_PAGE_SIZE != 0:
       exit_with_error(f'{setting} must be a multiple of WebAssembly page size (64KiB), was {settings[setting]}')
@@ -2324,6 +2341,10 @@ def phase_linker_setup(options, state, newargs, settings_map):
     # see what it itself calls)
     if settings.USE_PTHREADS:
       settings.ASYNCIFY_IMPORTS += ['__call_main']
+    # futex waits on the main thread can sleep, which the mutexes and condition
+    # variables in libc reach
+    if settings.MAIN_THREAD_ASYNC_WAITS:
+      settings.ASYNCIFY_IMPORTS += ['emscripten_futex_wait']
     # add the default imports
     settings.ASYNCIFY_IMPORTS += DEFAULT_ASYNCIFY_IMPORTS
 
@@ -2347,6 +2368,31 @@ def phase_linker_setup(options, state, newargs, settings_map):
     if settings.SINGLE_FILE:
       exit_with_error('NODE_CODE_CACHING saves a file on the side and is not compatible with SINGLE_FILE')
 
+  if settings.WASM_MODULE_CACHE:
+    if not settings.WASM_ASYNC_COMPILATION:
+      exit_with_error('WASM_MODULE_CACHE requires async compilation (WASM_ASYNC_COMPILATION=1)')
+    if settings.MINIMAL_RUNTIME:
+      exit_with_error('WASM_MODULE_CACHE is not compatible with MINIMAL_RUNTIME')
+    if settings.SINGLE_FILE:
+      exit_with_error('WASM_MODULE_CACHE fetches the wasm binary separately and is not compatible with SINGLE_FILE')
+
+  if settings.HEAP_SNAPSHOT:
+    if not shared.target_environment_may_be('node'):
+      exit_with_error('HEAP_SNAPSHOT runs the program in node at link time, but target environments do not include it')
+    if settings.USE_PTHREADS:
+      exit_with_error('HEAP_SNAPSHOT is not compatible with pthreads')
+    if settings.RELOCATABLE:
+      exit_with_error('HEAP_SNAPSHOT is not compatible with dynamic linking')
+    if settings.ALLOW_TABLE_GROWTH:
+      exit_with_error('HEAP_SNAPSHOT cannot capture functions added to the table at runtime, and is not compatible with ALLOW_TABLE_GROWTH')
+    if settings.WASM2JS or settings.SINGLE_FILE:
+      exit_with_error('HEAP_SNAPSHOT requires a separate wasm binary (it is not compatible with WASM2JS or SINGLE_FILE)')
+    if settings.EXPORT_ES6 or settings.MINIMAL_RUNTIME:
+      exit_with_error('HEAP_SNAPSHOT is not compatible with EXPORT_ES6 or MINIMAL_RUNTIME')
+    if settings.EMBIND:
+      exit_with_error('HEAP_SNAPSHOT is not compatible with embind, which registers bindings in JS from global constructors')
+    settings.EXPORTED_FUNCTIONS += ['_emscripten_snapshot_restored']
+
   if not shared.JS.isidentifier(settings.EXPORT_NAME):
     exit_with_error(f'EXPORT_NAME is not a valid JS identifier: `{settings.EXPORT_NAME}`')
 
@@ -2582,7 +2628,7 @@ def phase_link(linker_arguments, wasm_target):
   js_syms = None
   if settings.LLD_REPORT_UNDEFINED and settings.ERROR_ON_UNDEFINED_SYMBOLS:
     js_syms = get_all_js_syms()
-  building.link_lld(linker_arguments, wasm_target, external_symbols=js_syms)
+  building.link_lld(linker_arguments, wasm_target, external_symbols=js_syms, link_state_dir=settings.LINK_STATE_DIR)
 
 
 @ToolchainProfiler.profile_block('post_link')
@@ -3134,6 +3180,39 @@ def parse_args(newargs):
   return options, settings_changes, user_js_defines, newargs
 
 
+def needs_js_transforms():
+  return settings.SUPPORT_BIG_ENDIAN or settings.CAN_ADDRESS_2GB or \
+      (settings.USE_PTHREADS and settings.ALLOW_MEMORY_GROWTH) or \
+      settings.USE_ASAN or settings.SAFE_HEAP
+
+
+def apply_js_transforms(js_file):
+  if settings.SUPPORT_BIG_ENDIAN:
+    js_file = building.little_endian_heap(js_file)
+
+  # >=2GB heap support requires pointers in JS to be unsigned. rather than
+  # require all pointers to be unsigned by default, which increases code size
+  # a little, keep them signed, and just unsign them here if we need that.
+  if settings.CAN_ADDRESS_2GB:
+    js_file = building.use_unsigned_pointers_in_js(js_file)
+
+  # pthreads memory growth requires some additional JS fixups.
+  # note that we must do this after handling of unsigned pointers. unsigning
+  # adds some >>> 0 things, while growth will replace a HEAP8 with a call to
+  # a method to get the heap, and that call would not be recognized by the
+  # unsigning pass
+  if settings.USE_PTHREADS and settings.ALLOW_MEMORY_GROWTH:
+    js_file = building.apply_wasm_memory_growth(js_file)
+
+  if settings.USE_ASAN:
+    js_file = building.instrument_js_for_asan(js_file)
+
+  if settings.SAFE_HEAP:
+    js_file = building.instrument_js_for_safe_heap(js_file)
+
+  return js_file
+
+
 @ToolchainProfiler.profile_block('binaryen')
 def phase_binaryen(target, options, wasm_target):
   global final_js
@@ -3164,6 +3243,11 @@ def phase_binaryen(target, options, wasm_target):
   # run wasm-opt if we have work for it: either passes, or if we are using
   # source maps (which requires some extra processing to keep the source map
   # but remove DWARF)
+  # The JS transforms don't look at the wasm, so run them while wasm-opt works
+  # on it.
+  js_transforms = None
+  if final_js and needs_js_transforms():
+    js_transforms = building.BackgroundTask(apply_js_transforms, final_js)
   passes = get_binaryen_passes()
   if passes or settings.GENERATE_SOURCE_MAP:
     # if we need to strip certain sections, and we have wasm-opt passes
@@ -3181,10 +3265,11 @@ def phase_binaryen(target, options, wasm_target):
                           wasm_target,
                           args=passes,
                           debug=intermediate_debug_info)
-  elif strip_debug or strip_producers:
+  elif (strip_debug or strip_producers) and not (settings.INCREMENTAL_LINK and settings.OPT_LEVEL < 2):
     # we are not running wasm-opt. if we need to strip certain sections
     # then do so using llvm-objcopy which is fast and does not rewrite the
-    # code (which is better for debug info)
+    # code (which is better for debug info). incremental links at -O0 and -O1
+    # skip even that, to save a pass over the binary.
     building.save_intermediate(wasm_target, 'pre-strip.wasm')
     building.strip(wasm_target, wasm_target, debug=strip_debug, producers=strip_producers)
 
@@ -3192,31 +3277,15 @@ def phase_binaryen(target, options, wasm_target):
     building.save_intermediate(wasm_target, 'pre-ctors.wasm')
     building.eval_ctors(final_js, wasm_target, debug_info=intermediate_debug_info)
 
+  if settings.HEAP_SNAPSHOT:
+    building.save_intermediate(wasm_target, 'pre-snapshot.wasm')
+    building.take_heap_snapshot(final_js, wasm_target)
+
   # after generating the wasm, do some final operations
 
   if final_js:
-    if settings.SUPPORT_BIG_ENDIAN:
-      final_js = building.little_endian_heap(final_js)
-
-    # >=2GB heap support requires pointers in JS to be unsigned. rather than
-    # require all pointers to be unsigned by default, which increases code size
-    # a little, keep them signed, and just unsign them here if we need that.
-    if settings.CAN_ADDRESS_2GB:
-      final_js = building.use_unsigned_pointers_in_js(final_js)
-
-    # pthreads memory growth requires some additional JS fixups.
-    # note that we must do this after handling of unsigned pointers. unsigning
-    # adds some >>> 0 things, while growth will replace a HEAP8 with a call to
-    # a method to get the heap, and that call would not be recognized by the
-    # unsigning pass
-    if settings.USE_PTHREADS and settings.ALLOW_MEMORY_GROWTH:
-      final_js = building.apply_wasm_memory_growth(final_js)
-
-    if settings.USE_ASAN:
-      final_js = building.instrument_js_for_asan(final_js)
-
-    if settings.SAFE_HEAP:
-      final_js = building.instrument_js_for_safe_heap(final_js)
+    if js_transforms:
+      final_js = js_transforms.wait()
 
     if settings.OPT_LEVEL >= 2 and settings.DEBUG_LEVEL <= 2:
       # minify the JS. Do not minify whitespace if Closure is used, so that
@@ -3309,6 +3378,12 @@ def phase_binaryen(target, options, wasm_target):
      building.os.path.exists(wasm_target):
     building.run_wasm_opt(wasm_target, wasm_target)
 
+  # the compiled code caches are keyed by the hash of the final binary
+  if final_js and (settings.NODE_CODE_CACHING or settings.WASM_MODULE_CACHE) and not settings.WASM2JS:
+    js = read_file(final_js)
+    js = do_replace(js, '<<< WASM_BINARY_HASH >>>', hashlib.sha256(read_binary(wasm_target)).hexdigest())
+    write_file(final_js, js)
+
   # replace placeholder strings with correct subresource locations
   if final_js and settings.SINGLE_FILE and not settings.WASM2JS:
     js = read_file(final_js)
@@ -12,6 +12,8 @@ headers, for the libc implementation in JS).
 from tools.toolchain_profiler import ToolchainProfiler
 
 import os
+import glob
+import hashlib
 import json
 import subprocess
 import time
@@ -161,7 +163,46 @@ def apply_static_code_hooks(forwarded_json, code):
   return code
 
 
+def get_js_compiler_key():
+  # The output of the JS compiler depends on the settings, and on the files it
+  # reads: the JS libraries (ours and the user's), the struct info, and any
+  # settings given as response files.
+  key = hashlib.sha256(json.dumps([shared.EMSCRIPTEN_VERSION, os.getcwd(), settings.dict()], sort_keys=True).encode())
+  inputs = sorted(glob.glob(path_from_root('src', '**', '*.js'), recursive=True))
+  inputs += [lib for lib in settings.JS_LIBRARIES if os.path.isabs(lib)]
+  if settings.STRUCT_INFO:
+    inputs.append(settings.STRUCT_INFO)
+  for value in settings.dict().values():
+    if isinstance(value, str) and value.startswith('@') and os.path.isfile(value[1:]):
+      inputs.append(value[1:])
+  for filename in inputs:
+    key.update(utils.read_binary(filename))
+  return key.hexdigest()
+
+
 def compile_settings():
+  if not settings.LINK_STATE_DIR:
+    return run_js_compiler()
+
+  # In incremental links, reuse the output of the previous run if nothing that
+  # goes into it has changed.  The run that lists the JS library symbols for
+  # LLD_REPORT_UNDEFINED is kept separately.
+  name = 'jscompiler-symbols' if settings.ONLY_CALC_JS_SYMBOLS else 'jscompiler'
+  key_file = os.path.join(settings.LINK_STATE_DIR, name + '.key')
+  saved_output = os.path.join(settings.LINK_STATE_DIR, name + '.js')
+  key = get_js_compiler_key()
+  if os.path.exists(key_file) and utils.read_file(key_file) == key and os.path.exists(saved_output):
+    logger.debug('incremental link: JS compiler inputs are unchanged, reusing the previous output')
+    glue, forwarded_data = utils.read_file(saved_output).split('//FORWARDED_DATA:')
+    return glue, forwarded_data
+  shared.try_delete(key_file)
+  glue, forwarded_data = run_js_compiler()
+  utils.write_file(saved_output, glue + '//FORWARDED_DATA:' + forwarded_data)
+  utils.write_file(key_file, key)
+  return glue, forwarded_data
+
+
+def run_js_compiler():
   stderr_file = os.environ.get('EMCC_STDERR_FILE')
   if stderr_file:
     stderr_file = os.path.abspath(stderr_file)
@@ -7,9 +7,6 @@
 var Fetch = {
   xhrs: [],
 
-  // The web worker that runs proxied file I/O requests. (this field is populated on demand, start as undefined to save code size)
-  // worker: undefined,
-
   // Specifies an instance to the IndexedDB database. The database is opened
   // as a preload step before the Emscripten application starts. (this field is populated on demand, start as undefined to save code size)
   // dbInstance: undefined,
@@ -288,6 +285,7 @@ function fetchXHR(fetch, onsuccess, onerror, onprogress, onreadystatechange) {
   xhr.open(requestMethod, url_, !fetchAttrSynchronous, userNameStr, passwordStr);
   if (!fetchAttrSynchronous) xhr.timeout = timeoutMsecs; // XHR timeout field is only accessible in async XHRs, and must be set after .open() but before .send().
   xhr.url_ = url_; // Save the url for debugging purposes (and for comparing to the responseURL that server side advertised)
+  xhr.fetch_ = fetch; // So that fetchAbort() can tell that this is the XHR of the fetch.
 #if ASSERTIONS
   assert(!fetchAttrStreamData, 'streaming uses moz-chunked-arraybuffer which is no longer supported; TODO: rewrite using fetch()');
 #endif
@@ -568,6 +566,21 @@ function fetchGetResponseHeaders(id, dst, dstSizeBytes) {
     return Math.min(lengthBytes, dstSizeBytes);
 }
 
+// Aborts the XHR of a fetch if it is still in flight, after clearing its
+// handlers so that the fetch hears nothing more from it. Returns whether it did.
+function fetchAbort(fetch) {
+  var id = HEAPU32[fetch + {{{ C_STRUCTS.emscripten_fetch_t.id }}} >> 2];
+  var xhr = Fetch.xhrs[id-1];
+  // Until its XHR is created, the id of a fetch can match another fetch's XHR.
+  if (!xhr || xhr.fetch_ !== fetch || xhr.readyState === 4 /*DONE*/) return 0;
+#if FETCH_DEBUG
+  console.log('fetch: aborting xhr of URL "' + xhr.url_ + '"');
+#endif
+  xhr.onload = xhr.onerror = xhr.ontimeout = xhr.onprogress = xhr.onreadystatechange = null;
+  xhr.abort();
+  return 1;
+}
+
 //Delete the xhr JS object, allowing it to be garbage collected.
 function fetchFree(id) {
   //Note: should just be [id], but indexes off by 1 (see: #8803)
@@ -7,8 +7,13 @@
 
 // LLVM => JavaScript compiler, main entry point
 
-var nodeFS = require('fs');
+nodeFS = require('fs');
 nodePath = require('path');
+nodeCrypto = require('crypto');
+
+// The globals that node itself defines, as opposed to the ones that the
+// settings and the compiler code below define.  See LibraryCache.
+builtinGlobals = new Set(Object.getOwnPropertyNames(global));
 
 print = (x) => {
   process['stdout'].write(x + '\n');
@@ -9,7 +9,7 @@
 /*global _malloc, _free, _memcpy*/
 /*global FUNCTION_TABLE, HEAP8, HEAPU8, HEAP16, HEAPU16, HEAP32, HEAPU32, HEAPF32, HEAPF64*/
 /*global readLatin1String*/
-/*global Emval, emval_handle_array, __emval_decref*/
+/*global Emval, emval_values, __emval_decref*/
 /*global ___getTypeName*/
 /*jslint sub:true*/ /* The symbols 'fromWireType' and 'toWireType' must be accessed via array notation to be closure-safe since craftInvokerFunction crafts functions as strings that can't be closured. */
 
@@ -26,6 +26,70 @@
 /*global throwInstanceAlreadyDeleted, shallowCopyInternalPointer*/
 /*global RegisteredPointer_fromWireType, constNoSmartPtrRawPointerToWireType, nonConstNoSmartPtrRawPointerToWireType, genericPointerToWireType*/
 
+{{{ (function() {
+  // Code generation for the invokers in $createPrecompiledInvoker.  These are
+  // written out when the library is processed, one per argument count, so that
+  // binding a function only needs to pick one rather than compile a new one.
+  global.embind = {
+    maxPrecompiledInvokerArgs: 8,
+
+    makePrecompiledInvokers: function() {
+      var ret = '';
+      for (var argCount = 0; argCount <= this.maxPrecompiledInvokerArgs; argCount++) {
+        var args = [];
+        var argsWired = [];
+        for (var i = 0; i < argCount; i++) {
+          args.push('arg' + i);
+          argsWired.push('arg' + i + 'Wired');
+        }
+        ret += '      case ' + argCount + ': {\n';
+        for (var i = 0; i < argCount; i++) {
+          ret += '        var argType' + i + ' = argTypes[' + (i + 2) + '];\n';
+          ret += '        var arg' + i + 'Dtor = argType' + i + '.destructorFunction;\n';
+        }
+        ret += '        return function(' + args.join(', ') + ') {\n';
+        ret += '          if (arguments.length !== ' + argCount + ') {\n';
+        ret += "            throwBindingError('function ' + humanName + ' called with ' + arguments.length + ' arguments, expected " + argCount + " args!');\n";
+        ret += '          }\n';
+        if (EMSCRIPTEN_TRACING) {
+          ret += "          Module.emscripten_trace_enter_context('embind::' + humanName);\n";
+        }
+        ret += '          var destructors = needsDestructorStack ? [] : null;\n';
+        ret += "          var thisWired = isClassMethodFunc ? classParam['toWireType'](destructors, this) : 0;\n";
+        for (var i = 0; i < argCount; i++) {
+          ret += '          var arg' + i + "Wired = argType" + i + "['toWireType'](destructors, arg" + i + ');\n';
+        }
+        ret += '          var rv = isClassMethodFunc ?\n';
+        ret += '            cppInvokerFunc(' + ['cppTargetFunc', 'thisWired'].concat(argsWired).join(', ') + ') :\n';
+        ret += '            cppInvokerFunc(' + ['cppTargetFunc'].concat(argsWired).join(', ') + ');\n';
+        if (ASYNCIFY) {
+          ret += '          function onDone(rv) {\n';
+        }
+        ret += '          if (destructors) {\n';
+        ret += '            runDestructors(destructors);\n';
+        ret += '          } else {\n';
+        ret += '            if (thisDtor) thisDtor(thisWired);\n';
+        for (var i = 0; i < argCount; i++) {
+          ret += '            if (arg' + i + 'Dtor) arg' + i + 'Dtor(arg' + i + 'Wired);\n';
+        }
+        ret += '          }\n';
+        if (EMSCRIPTEN_TRACING) {
+          ret += '          Module.emscripten_trace_exit_context();\n';
+        }
+        ret += "          if (returns) return retType['fromWireType'](rv);\n";
+        if (ASYNCIFY) {
+          ret += '          }\n';
+          ret += '          return Asyncify.currData ? Asyncify.whenDone().then(onDone) : onDone(rv);\n';
+        }
+        ret += '        };\n';
+        ret += '      }\n';
+      }
+      return ret;
+    },
+  };
+  return null;
+})(); }}}
+
 var LibraryEmbind = {
   $InternalError__postset: "InternalError = Module['InternalError'] = extendError(Error, 'InternalError');",
   $InternalError__deps: ['$extendError'],
@@ -869,8 +933,7 @@ var LibraryEmbind = {
     });
   },
 
-  _embind_register_memory_view__deps: ['$readLatin1String', '$registerType'],
-  _embind_register_memory_view: function(rawType, dataTypeIndex, name) {
+  $getTypedArrayType: function(dataTypeIndex) {
     var typeMapping = [
         Int8Array,
         Uint8Array,
@@ -885,8 +948,12 @@ var LibraryEmbind = {
         BigUint64Array,
 #endif
     ];
+    return typeMapping[dataTypeIndex];
+  },
 
-    var TA = typeMapping[dataTypeIndex];
+  _embind_register_memory_view__deps: ['$readLatin1String', '$registerType', '$getTypedArrayType'],
+  _embind_register_memory_view: function(rawType, dataTypeIndex, name) {
+    var TA = getTypedArrayType(dataTypeIndex);
 
     function decodeMemoryView(handle) {
         handle = handle >> 2;
@@ -907,6 +974,86 @@ var LibraryEmbind = {
     });
   },
 
+  _embind_register_typed_array_vector__deps: [
+    '$readLatin1String', '$registerType', '$getTypedArrayType',
+    '$embind__requireFunction', '$simpleReadValueFromPointer',
+    '$throwBindingError', 'embind_repr'],
+  _embind_register_typed_array_vector: function(
+    rawType,
+    rawViewType,
+    dataTypeIndex,
+    name,
+    constructorSignature,
+    rawConstructor,
+    dataSignature,
+    rawData,
+    sizeSignature,
+    rawSize,
+    destructorSignature,
+    rawDestructor
+  ) {
+    var TA = getTypedArrayType(dataTypeIndex);
+    name = readLatin1String(name);
+    rawConstructor = embind__requireFunction(constructorSignature, rawConstructor);
+    rawData = embind__requireFunction(dataSignature, rawData);
+    rawSize = embind__requireFunction(sizeSignature, rawSize);
+    rawDestructor = embind__requireFunction(destructorSignature, rawDestructor);
+
+    // Returns a typed array that aliases the vector's elements in the heap.
+    function viewElements(ptr, size) {
+        var data = rawData(ptr);
+#if CAN_ADDRESS_2GB
+        data >>>= 0;
+#endif
+        return new TA(buffer, data, size);
+    }
+
+    function toWireType(destructors, value) {
+        if (!(Array.isArray(value) || (ArrayBuffer.isView(value) && !(value instanceof DataView)))) {
+            throwBindingError('Cannot pass "' + _embind_repr(value) + '" as a ' + name);
+        }
+        var length = value.length;
+        var ptr = rawConstructor(length);
+        if (length) {
+            viewElements(ptr, length).set(value);
+        }
+        if (destructors !== null) {
+            destructors.push(rawDestructor, ptr);
+        }
+        return ptr;
+    }
+
+    registerType(rawType, {
+        name: name,
+        'fromWireType': function(ptr) {
+            var rv = viewElements(ptr, rawSize(ptr)).slice();
+            rawDestructor(ptr);
+            return rv;
+        },
+        'toWireType': toWireType,
+        'argPackAdvance': 8,
+        'readValueFromPointer': simpleReadValueFromPointer,
+        destructorFunction: rawDestructor,
+    });
+
+    // Returned with the return_typed_array_view policy.  The vector stays
+    // alive until the view is deleted.
+    registerType(rawViewType, {
+        name: name + ' view',
+        'fromWireType': function(ptr) {
+            var rv = viewElements(ptr, rawSize(ptr));
+            rv['delete'] = function() {
+                rawDestructor(ptr);
+            };
+            return rv;
+        },
+        'toWireType': toWireType,
+        'argPackAdvance': 8,
+        'readValueFromPointer': simpleReadValueFromPointer,
+        destructorFunction: rawDestructor,
+    });
+  },
+
   $runDestructors: function(destructors) {
     while (destructors.length) {
         var ptr = destructors.pop();
@@ -950,9 +1097,29 @@ var LibraryEmbind = {
 
   // The path to interop from JS code to C++ code:
   // (hand-written JS code) -> (autogenerated JS invoker) -> (template-generated C++ invoker) -> (target C++ function)
+  // Returns an invoker for a function with up to
+  // embind.maxPrecompiledInvokerArgs arguments, which does the same as the one
+  // craftInvokerFunction would generate for it, but without compiling any code
+  // at runtime.
+  $createPrecompiledInvoker__deps: [
+    '$runDestructors', '$throwBindingError',
+#if ASYNCIFY
+    '$Asyncify',
+#endif
+  ],
+  $createPrecompiledInvoker: function(humanName, argTypes, isClassMethodFunc, needsDestructorStack, returns, cppInvokerFunc, cppTargetFunc) {
+    var retType = argTypes[0];
+    var classParam = argTypes[1];
+    var thisDtor = isClassMethodFunc ? classParam.destructorFunction : null;
+    switch (argTypes.length - 2) {
+{{{ embind.makePrecompiledInvokers() }}}
+    }
+  },
+
   // craftInvokerFunction generates the JS invoker function for each function exposed to JS through embind.
   $craftInvokerFunction__deps: [
     '$makeLegalFunctionName', '$new_', '$runDestructors', '$throwBindingError',
+    '$createPrecompiledInvoker',
   #if ASYNCIFY
     '$Asyncify',
   #endif
@@ -994,6 +1161,15 @@ var LibraryEmbind = {
 
     var returns = (argTypes[0].name !== "void");
 
+    if (argCount - 2 <= {{{ embind.maxPrecompiledInvokerArgs }}}) {
+      var invokerFunction = createPrecompiledInvoker(humanName, argTypes, isClassMethodFunc, needsDestructorStack, returns, cppInvokerFunc, cppTargetFunc);
+#if DYNAMIC_EXECUTION
+      // Give it the same name a generated invoker would have.
+      Object.defineProperty(invokerFunction, 'name', {value: makeLegalFunctionName(humanName)});
+#endif
+      return invokerFunction;
+    }
+
 #if DYNAMIC_EXECUTION == 0
     var expectedArgCount = argCount - 2;
     var argsWired = new Array(expectedArgCount);
@@ -12,15 +12,25 @@
 /*jslint sub:true*/ /* The symbols 'fromWireType' and 'toWireType' must be accessed via array notation to be closure-safe since craftInvokerFunction crafts functions as strings that can't be closured. */
 
 // -- jshint doesn't understand library syntax, so we need to mark the symbols exposed here
-/*global getStringOrSymbol, emval_handle_array, Emval, __emval_unregister, count_emval_handles, emval_symbols, emval_free_list, get_first_emval, __emval_decref, emval_newers*/
+/*global getStringOrSymbol, emval_values, emval_refcounts, emval_generations, Emval, __emval_unregister, count_emval_handles, emval_symbols, emval_free_list, get_first_emval, __emval_decref, emval_newers*/
 /*global craftEmvalAllocator, __emval_addMethodCaller, emval_methodCallers, LibraryManager, mergeInto, __emval_allocateDestructors, global, __emval_lookupTypes, makeLegalFunctionName*/
 /*global emval_get_global*/
 
 var LibraryEmVal = {
-  $emval_handle_array: [{},
-    {value: undefined},{value: null},
-    {value: true},{value: false}], // reserve zero and special values
+  // The values that handles refer to are kept in emval_values, indexed by
+  // handle, with their reference counts in the parallel emval_refcounts array.
+  // Handle zero is never used, and 1 to 4 are reserved for undefined, null,
+  // true and false, which are not reference counted.
+  $emval_values: [undefined, undefined, null, true, false],
+  $emval_refcounts: '=new Uint32Array(64)',
   $emval_free_list: [],
+#if ASSERTIONS
+  // In builds with assertions, bits 24 and up of a handle hold a generation
+  // number for its slot, which changes whenever the slot is freed, so that
+  // using a handle after it has been released is caught rather than silently
+  // referring to whatever value has since reused the slot.
+  $emval_generations: '=new Uint8Array(64)',
+#endif
   $emval_symbols: {}, // address -> string
 
   $init_emval__deps: ['$count_emval_handles', '$get_first_emval'],
@@ -30,22 +40,22 @@ var LibraryEmVal = {
     Module['get_first_emval'] = get_first_emval;
   },
 
-  $count_emval_handles__deps: ['$emval_handle_array'],
+  $count_emval_handles__deps: ['$emval_values', '$emval_refcounts'],
   $count_emval_handles: function() {
     var count = 0;
-    for (var i = 5; i < emval_handle_array.length; ++i) {
-        if (emval_handle_array[i] !== undefined) {
+    for (var i = 5; i < emval_values.length; ++i) {
+        if (emval_refcounts[i]) {
             ++count;
         }
     }
     return count;
   },
 
-  $get_first_emval__deps: ['$emval_handle_array'],
+  $get_first_emval__deps: ['$emval_values', '$emval_refcounts'],
   $get_first_emval: function() {
-    for (var i = 5; i < emval_handle_array.length; ++i) {
-        if (emval_handle_array[i] !== undefined) {
-            return emval_handle_array[i];
+    for (var i = 5; i < emval_values.length; ++i) {
+        if (emval_refcounts[i]) {
+            return {refcount: emval_refcounts[i], value: emval_values[i]};
         }
     }
     return null;
@@ -66,13 +76,20 @@ var LibraryEmVal = {
     }
   },
 
-  $Emval__deps: ['$emval_handle_array', '$emval_free_list', '$throwBindingError', '$init_emval'],
+  $Emval__deps: ['$emval_values', '$emval_refcounts', '$emval_free_list',
+#if ASSERTIONS
+    '$emval_generations',
+#endif
+    '$throwBindingError', '$init_emval'],
   $Emval: {
     toValue: function(handle) {
       if (!handle) {
           throwBindingError('Cannot use deleted val. handle = ' + handle);
       }
-      return emval_handle_array[handle].value;
+#if ASSERTIONS
+      handle = Emval.toIndex(handle);
+#endif
+      return emval_values[handle];
     },
 
     toHandle: function(value) {
@@ -82,31 +99,77 @@ var LibraryEmVal = {
         case true :{ return 3; }
         case false :{ return 4; }
         default:{
-          var handle = emval_free_list.length ?
+          var index = emval_free_list.length ?
               emval_free_list.pop() :
-              emval_handle_array.length;
-  
-          emval_handle_array[handle] = {refcount: 1, value: value};
-          return handle;
+              emval_values.length;
+          if (index === emval_refcounts.length) {
+            var refcounts = new Uint32Array(index * 2);
+            refcounts.set(emval_refcounts);
+            emval_refcounts = refcounts;
+#if ASSERTIONS
+            var generations = new Uint8Array(index * 2);
+            generations.set(emval_generations);
+            emval_generations = generations;
+#endif
+          }
+
+          emval_values[index] = value;
+          emval_refcounts[index] = 1;
+#if ASSERTIONS
+          assert(index < 0x1000000, 'too many live val handles');
+          return index | (emval_generations[index] << 24);
+#else
+          return index;
+#endif
           }
         }
-    }
+    },
+
+#if ASSERTIONS
+    // Returns the slot that a handle refers to, checking that the handle has
+    // not been released.
+    toIndex: function(handle) {
+      var index = handle & 0xFFFFFF;
+      if (index > 4 && (!emval_refcounts[index] || (handle >>> 24) !== emval_generations[index])) {
+          throwBindingError('Cannot use val after it has been released. handle = ' + handle);
+      }
+      return index;
+    },
+#endif
   },
 
   _emval_incref__sig: 'vi',
-  _emval_incref__deps: ['$emval_handle_array'],
+  _emval_incref__deps: ['$emval_refcounts',
+#if ASSERTIONS
+    '$Emval',
+#endif
+  ],
   _emval_incref: function(handle) {
+#if ASSERTIONS
+    handle = Emval.toIndex(handle);
+#endif
     if (handle > 4) {
-        emval_handle_array[handle].refcount += 1;
+        emval_refcounts[handle] += 1;
     }
   },
 
   _emval_decref__sig: 'vi',
-  _emval_decref__deps: ['$emval_free_list', '$emval_handle_array'],
+  _emval_decref__deps: ['$emval_free_list', '$emval_values', '$emval_refcounts',
+#if ASSERTIONS
+    '$Emval', '$emval_generations',
+#endif
+  ],
   _emval_decref: function(handle) {
-    if (handle > 4 && 0 === --emval_handle_array[handle].refcount) {
-        emval_handle_array[handle] = undefined;
+#if ASSERTIONS
+    handle = Emval.toIndex(handle);
+#endif
+    if (handle > 4 && 0 === --emval_refcounts[handle]) {
+        emval_values[handle] = undefined;
         emval_free_list.push(handle);
+#if ASSERTIONS
+        // Generations stay below 128 so that handles remain positive.
+        emval_generations[handle] = (emval_generations[handle] + 1) & 0x7F;
+#endif
     }
   },
 
@@ -313,6 +313,11 @@ LibraryManager.library = {
     updateGlobalBufferAndViews(wasmMemory.buffer);
   },
 
+  // Called by munmap() in standalone builds for a file mapping, so that a host
+  // that maps files into memory in fd_pread can release them.  Files are
+  // always copied here, so there is nothing to do.
+  _emscripten_notify_munmap: function(addr, length) {},
+
   system__deps: ['$setErrNo'],
   system: function(command) {
 #if ENVIRONMENT_MAY_BE_NODE
@@ -3494,6 +3499,31 @@ LibraryManager.library = {
 #endif
   },
 
+#if HEAP_SNAPSHOT
+  _emscripten_take_heap_snapshot__deps: ['emscripten_stack_get_base', 'emscripten_stack_get_end'],
+#endif
+  _emscripten_take_heap_snapshot__sig: 'v',
+  _emscripten_take_heap_snapshot: function() {
+#if HEAP_SNAPSHOT
+    // emcc runs the program under node at link time with this set, and turns
+    // the memory written here into the data segments of the final binary.
+    var snapshotFile = ENVIRONMENT_IS_NODE && process.env['EMCC_HEAP_SNAPSHOT_FILE'];
+    if (!snapshotFile) {
+      return;
+    }
+    if (heapSnapshotCtorImports.length) {
+      err('HEAP_SNAPSHOT: global constructors called JS imports, whose effects cannot be part of the snapshot: ' + heapSnapshotCtorImports.join(', '));
+      process['exit'](1);
+    }
+    var heap = HEAPU8.slice();
+    // The program restarts from main() so nothing on the stack is live; leave
+    // it out of the snapshot.
+    heap.fill(0, _emscripten_stack_get_end(), _emscripten_stack_get_base());
+    require('fs').writeFileSync(snapshotFile, heap);
+    process['exit'](0);
+#endif
+  },
+
   _emscripten_out__sig: 'vi',
   _emscripten_out: function(str) {
 #if ASSERTIONS
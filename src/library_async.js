@@ -49,6 +49,14 @@ mergeInto(LibraryManager.library, {
     callStackId: 0,
     asyncPromiseHandlers: null, // { resolve, reject } pair for when *all* asynchronicity is done
     sleepCallbacks: [], // functions to call every time we sleep
+#if MAIN_THREAD_ASYNC_WAITS
+    // Whether the call at the bottom of exportCallStack was made by something
+    // that copes with it suspending, like callMain() or an async ccall, which
+    // set nextExportCanSleep right before making it. Futex waits only suspend
+    // inside such calls (see emscripten_futex_wait).
+    exportCanSleep: false,
+    nextExportCanSleep: false,
+#endif
 
     getCallStackId: function(funcName) {
       var id = Asyncify.callStackNameToId[funcName];
@@ -117,6 +125,14 @@ mergeInto(LibraryManager.library, {
             ret[x] = function() {
 #if ASYNCIFY_DEBUG >= 2
               err('ASYNCIFY: ' + '  '.repeat(Asyncify.exportCallStack.length) + ' try ' + x);
+#endif
+#if MAIN_THREAD_ASYNC_WAITS
+              if (!Asyncify.exportCallStack.length) {
+                // A call that is being rewound was already suspended once, so
+                // its caller copes with that.
+                Asyncify.exportCanSleep = Asyncify.nextExportCanSleep || Asyncify.state === Asyncify.State.Rewinding;
+                Asyncify.nextExportCanSleep = false;
+              }
 #endif
               Asyncify.exportCallStack.push(x);
               try {
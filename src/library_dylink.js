@@ -76,12 +76,59 @@ var LibraryDylink = {
     ;
   },
 
+  // Like calling addFunction() on each of the given functions, except that the
+  // table is grown (at most) once for all of them rather than once per
+  // function.
+  $addFunctionsBatch__internal: true,
+  $addFunctionsBatch: function(funcs) {
+    if (!functionsInTableMap) {
+      functionsInTableMap = new WeakMap();
+      updateTableMap(0, wasmTable.length);
+    }
+    // Only functions not already in the table need a slot, and a function
+    // that appears more than once in the batch only needs one.
+    var needed = 0;
+    var counted = new Set();
+    for (var i = 0; i < funcs.length; i++) {
+      if (!functionsInTableMap.has(funcs[i]) && !counted.has(funcs[i])) {
+        counted.add(funcs[i]);
+        needed++;
+      }
+    }
+    needed -= freeTableIndexes.length;
+    if (needed > 0) {
+      var base = wasmTable.length;
+      try {
+        wasmTable.grow(needed);
+      } catch (err) {
+        if (!(err instanceof RangeError)) {
+          throw err;
+        }
+        throw 'Unable to grow wasm table. Set ALLOW_TABLE_GROWTH.';
+      }
+      // Queue the new slots up behind the existing free ones, in the same
+      // order addFunction would have created them when growing one at a time.
+      var added = [];
+      for (var i = needed - 1; i >= 0; i--) {
+        added.push(base + i);
+      }
+      freeTableIndexes = added.concat(freeTableIndexes);
+    }
+    return funcs.map(function(func) {
+      return addFunction(func);
+    });
+  },
+
   $updateGOT__internal: true,
-  $updateGOT__deps: ['$GOT', '$isInternalSym'],
+  $updateGOT__deps: ['$GOT', '$isInternalSym', '$addFunctionsBatch'],
   $updateGOT: function(exports, replace) {
 #if DYLINK_DEBUG
     err("updateGOT: adding " + Object.keys(exports).length + " symbols");
 #endif
+    // Function exports need a table slot; these are collected and added to
+    // the table in one go at the end.
+    var funcSyms = [];
+    var funcs = [];
     for (var symName in exports) {
       if (isInternalSym(symName)) {
         continue;
@@ -103,10 +150,8 @@ var LibraryDylink = {
         err("updateGOT: before: " + symName + ' : ' + GOT[symName].value);
 #endif
         if (typeof value === 'function') {
-          GOT[symName].value = addFunction(value);
-#if DYLINK_DEBUG
-          err("updateGOT: FUNC: " + symName + ' : ' + GOT[symName].value);
-#endif
+          funcSyms.push(symName);
+          funcs.push(value);
         } else if (typeof value === 'number') {
           GOT[symName].value = value;
         } else if (typeof value === 'bigint') {
@@ -122,6 +167,13 @@ var LibraryDylink = {
       else if (GOT[symName].value != value) {
         err("updateGOT: EXISTING SYMBOL: " + symName + ' : ' + GOT[symName].value + " " + value);
       }
+#endif
+    }
+    var indexes = addFunctionsBatch(funcs);
+    for (var i = 0; i < funcSyms.length; i++) {
+      GOT[funcSyms[i]].value = indexes[i];
+#if DYLINK_DEBUG
+      err("updateGOT: FUNC: " + funcSyms[i] + ' : ' + indexes[i]);
 #endif
     }
 #if DYLINK_DEBUG
@@ -201,6 +253,9 @@ var LibraryDylink = {
   _dlsym_js: function(handle, symbol) {
     abort("To use dlopen, you need to use Emscripten's linking support, see https://github.com/emscripten-core/emscripten/wiki/Linking");
   },
+  // Without dlopen the only valid handle is the main program, which is never
+  // released.
+  _dlclose_js: function(handle) {},
 #else // MAIN_MODULE != 0
   // dynamic linker/loader (a-la ld.so on ELF systems)
   $LDSO: {
@@ -208,6 +263,12 @@ var LibraryDylink = {
     loadedLibsByName: {},
     // handle  -> dso; Used by dlsym
     loadedLibsByHandle: {},
+    // name -> WebAssembly.Module for libraries that have finished compiling.
+    // These are handed to new pthreads so that they don't need to fetch and
+    // compile them again.
+    compiledModules: {},
+    // name -> promise of WebAssembly.Module, for libraries being compiled
+    compilingModules: {},
   },
 
   $dlSetError__internal: true,
@@ -421,7 +482,7 @@ var LibraryDylink = {
   // Loads a side module from binary data or compiled Module. Returns the module's exports or a
   // promise that resolves to its exports if the loadAsync flag is set.
   $loadWebAssemblyModule__deps: [
-    '$loadDynamicLibrary', '$createInvokeFunction', '$getMemory',
+    '$loadDynamicLibrary', '$compileDynamicLibrary', '$LDSO', '$createInvokeFunction', '$getMemory',
     '$relocateExports', '$resolveGlobalSymbol', '$GOTHandler',
     '$getDylinkMetadata', '$alignMemory', '$zeroMemory',
   ],
@@ -573,8 +634,9 @@ var LibraryDylink = {
 
       if (flags.loadAsync) {
         if (binary instanceof WebAssembly.Module) {
-          var instance = new WebAssembly.Instance(binary, info);
-          return Promise.resolve(postInstantiation(instance));
+          return WebAssembly.instantiate(binary, info).then(function(instance) {
+            return postInstantiation(instance);
+          });
         }
         return WebAssembly.instantiate(binary, info).then(function(result) {
           return postInstantiation(result.instance);
@@ -588,6 +650,13 @@ var LibraryDylink = {
 
     // now load needed libraries and the module itself.
     if (flags.loadAsync) {
+      // Fetch and compile all the dependencies concurrently up front.  They
+      // are still instantiated one at a time, in order, below.
+      metadata.neededDynlibs.forEach(function(dynNeeded) {
+        if (!LDSO.loadedLibsByName[dynNeeded]) {
+          compileDynamicLibrary(dynNeeded, flags);
+        }
+      });
       return metadata.neededDynlibs.reduce(function(chain, dynNeeded) {
         return chain.then(function() {
           return loadDynamicLibrary(dynNeeded, flags);
@@ -603,6 +672,62 @@ var LibraryDylink = {
     return loadModule();
   },
 
+  // libData <- libFile
+  $loadLibData__internal: true,
+  $loadLibData: function(libFile, flags) {
+    // for wasm, we can use fetch for async, but for fs mode we can only imitate it
+    if (flags.fs && flags.fs.findObject(libFile)) {
+      var libData = flags.fs.readFile(libFile, {encoding: 'binary'});
+      if (!(libData instanceof Uint8Array)) {
+        libData = new Uint8Array(libData);
+      }
+      return flags.loadAsync ? Promise.resolve(libData) : libData;
+    }
+
+    if (flags.loadAsync) {
+      return new Promise(function(resolve, reject) {
+        readAsync(libFile, function(data) { resolve(new Uint8Array(data)); }, reject);
+      });
+    }
+
+    // load the binary synchronously
+    if (!readBinary) {
+      throw new Error(libFile + ': file not found, and synchronous loading of external files is not available');
+    }
+    return readBinary(libFile);
+  },
+
+  // Asynchronously fetches and compiles the library @ lib URL / path, and
+  // returns a promise of the WebAssembly.Module.  Each library is only
+  // compiled once, so this can be used to start compiling libraries ahead of
+  // the point at which they need to be instantiated.
+  $compileDynamicLibrary__internal: true,
+  $compileDynamicLibrary__deps: ['$LDSO', '$loadLibData'],
+  $compileDynamicLibrary: function(lib, flags) {
+    if (LDSO.compiledModules[lib]) {
+      return Promise.resolve(LDSO.compiledModules[lib]);
+    }
+    var compiling = LDSO.compilingModules[lib];
+    if (!compiling) {
+#if DYLINK_DEBUG
+      err('compileDynamicLibrary: ' + lib);
+#endif
+      compiling = loadLibData(lib, flags).then(function(libData) {
+        return WebAssembly.compile(libData);
+      }).then(function(module) {
+        LDSO.compiledModules[lib] = module;
+        delete LDSO.compilingModules[lib];
+        return module;
+      });
+      // Failures are reported to whoever ends up waiting on the result; don't
+      // treat a library that fails while we are still busy with others as an
+      // unhandled rejection.
+      compiling.catch(function() {});
+      LDSO.compilingModules[lib] = compiling;
+    }
+    return compiling;
+  },
+
   // loadDynamicLibrary loads dynamic library @ lib URL / path and returns
   // handle for loaded DSO.
   //
@@ -624,7 +749,7 @@ var LibraryDylink = {
   // If a library was already loaded, it is not loaded a second time. However
   // flags.global and flags.nodelete are handled every time a load request is made.
   // Once a library becomes "global" or "nodelete", it cannot be removed or unloaded.
-  $loadDynamicLibrary__deps: ['$LDSO', '$loadWebAssemblyModule', '$asmjsMangle', '$isInternalSym', '$mergeLibSymbols'],
+  $loadDynamicLibrary__deps: ['$LDSO', '$loadWebAssemblyModule', '$loadLibData', '$compileDynamicLibrary', '$asmjsMangle', '$isInternalSym', '$mergeLibSymbols'],
   $loadDynamicLibrary: function(lib, flags, handle) {
 #if DYLINK_DEBUG
     err('loadDynamicLibrary: ' + lib + ' handle:' + handle);
@@ -678,30 +803,6 @@ var LibraryDylink = {
       LDSO.loadedLibsByHandle[handle] = dso;
     }
 
-    // libData <- libFile
-    function loadLibData(libFile) {
-      // for wasm, we can use fetch for async, but for fs mode we can only imitate it
-      if (flags.fs && flags.fs.findObject(libFile)) {
-        var libData = flags.fs.readFile(libFile, {encoding: 'binary'});
-        if (!(libData instanceof Uint8Array)) {
-          libData = new Uint8Array(libData);
-        }
-        return flags.loadAsync ? Promise.resolve(libData) : libData;
-      }
-
-      if (flags.loadAsync) {
-        return new Promise(function(resolve, reject) {
-          readAsync(libFile, function(data) { resolve(new Uint8Array(data)); }, reject);
-        });
-      }
-
-      // load the binary synchronously
-      if (!readBinary) {
-        throw new Error(libFile + ': file not found, and synchronous loading of external files is not available');
-      }
-      return readBinary(libFile);
-    }
-
     // libModule <- lib
     function getLibModule() {
       // lookup preloaded cache first
@@ -711,14 +812,21 @@ var LibraryDylink = {
         return flags.loadAsync ? Promise.resolve(libModule) : libModule;
       }
 
+      // the library may already have been compiled, either on this thread or
+      // (for pthreads) on the main thread
+      var compiled = LDSO.compiledModules[lib];
+      if (compiled && !flags.loadAsync) {
+        return loadWebAssemblyModule(compiled, flags, handle);
+      }
+
       // module not preloaded - load lib data and create new module from it
       if (flags.loadAsync) {
-        return loadLibData(lib).then(function(libData) {
-          return loadWebAssemblyModule(libData, flags, handle);
+        return compileDynamicLibrary(lib, flags).then(function(module) {
+          return loadWebAssemblyModule(module, flags, handle);
         });
       }
 
-      return loadWebAssemblyModule(loadLibData(lib), flags, handle);
+      return loadWebAssemblyModule(loadLibData(lib, flags), flags, handle);
     }
 
     // module for lib is loaded - update the dso & global namespace
@@ -747,7 +855,7 @@ var LibraryDylink = {
   },
 
   $preloadDylibs__internal: true,
-  $preloadDylibs__deps: ['$loadDynamicLibrary', '$reportUndefinedSymbols'],
+  $preloadDylibs__deps: ['$LDSO', '$loadDynamicLibrary', '$compileDynamicLibrary', '$reportUndefinedSymbols'],
   $preloadDylibs: function() {
 #if DYLINK_DEBUG
     err('preloadDylibs');
@@ -760,11 +868,23 @@ var LibraryDylink = {
       return;
     }
 
-    // Load binaries asynchronously
+#if USE_PTHREADS
+    if (ENVIRONMENT_IS_PTHREAD && Module['compiledDylibs']) {
+      // Reuse the modules that the main thread has already compiled.
+      Object.assign(LDSO.compiledModules, Module['compiledDylibs']);
+    }
+#endif
+
+    // Load binaries asynchronously.  All the libraries are fetched and
+    // compiled concurrently, but instantiated one by one in order.
     addRunDependency('preloadDylibs');
+    var flags = {loadAsync: true, global: true, nodelete: true, allowUndefined: true};
+    dynamicLibraries.forEach(function(lib) {
+      compileDynamicLibrary(lib, flags);
+    });
     dynamicLibraries.reduce(function(chain, lib) {
       return chain.then(function() {
-        return loadDynamicLibrary(lib, {loadAsync: true, global: true, nodelete: true, allowUndefined: true});
+        return loadDynamicLibrary(lib, flags);
       });
     }, Promise.resolve()).then(function() {
       // we got them all, wonderful
@@ -880,6 +1000,48 @@ var LibraryDylink = {
     }
   },
 
+  $releaseCompiledModule__internal: true,
+  $releaseCompiledModule__deps: ['$LDSO'],
+  $releaseCompiledModule: function(handle) {
+    var dso = LDSO.loadedLibsByHandle[handle];
+    var lib = dso ? dso.name : UTF8ToString(handle + {{{ C_STRUCTS.dso.name }}});
+#if DYLINK_DEBUG
+    err('releaseCompiledModule: ' + lib);
+#endif
+    delete LDSO.compiledModules[lib];
+  },
+
+#if USE_PTHREADS
+  // The main thread's compiled modules are the ones handed to new pthreads.
+  $releaseCompiledModuleOnMainThread__deps: ['$releaseCompiledModule'],
+  $releaseCompiledModuleOnMainThread__proxy: 'async',
+  $releaseCompiledModuleOnMainThread__sig: 'vi',
+  $releaseCompiledModuleOnMainThread: function(handle) {
+    releaseCompiledModule(handle);
+  },
+#endif
+
+  // void dlclose(void* handle), once no handle to the library is left open.
+  // Wasm code can't be unloaded, but the library's compiled module no longer
+  // needs to be kept for loading it again.
+  _dlclose_js__deps: ['$releaseCompiledModule',
+#if USE_PTHREADS
+    '$releaseCompiledModuleOnMainThread',
+#endif
+  ],
+  _dlclose_js__sig: 'vi',
+  _dlclose_js: function(handle) {
+#if DYLINK_DEBUG
+    err('dlclose: ' + handle);
+#endif
+    releaseCompiledModule(handle);
+#if USE_PTHREADS
+    if (ENVIRONMENT_IS_PTHREAD) {
+      releaseCompiledModuleOnMainThread(handle);
+    }
+#endif
+  },
+
   // void* dlsym(void* handle, const char* symbol);
   _dlsym_js__deps: ['$dlSetError'],
   _dlsym_js__sig: 'iii',
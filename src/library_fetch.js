@@ -16,6 +16,7 @@ var LibraryFetch = {
   _emscripten_fetch_get_response_headers_length: fetchGetResponseHeadersLength,
   _emscripten_fetch_get_response_headers: fetchGetResponseHeaders,
   _emscripten_fetch_free: fetchFree,
+  _emscripten_fetch_abort: fetchAbort,
 
 #if FETCH_SUPPORT_INDEXEDDB
   $fetchDeleteCachedData: fetchDeleteCachedData,
@@ -24,6 +25,24 @@ var LibraryFetch = {
 #endif
   $fetchXHR: fetchXHR,
 
+#if USE_PTHREADS
+  // Called when the fetch thread in emscripten_fetch.cpp starts. Each Worker
+  // needs its own connection to IndexedDB, so this opens one for the thread
+  // before calling onready.
+  _emscripten_fetch_init_thread__deps: ['$Fetch'],
+  _emscripten_fetch_init_thread: function(onready) {
+#if FETCH_SUPPORT_INDEXEDDB
+    var done = function(db) {
+      Fetch.dbInstance = db;
+      {{{ makeDynCall('v', 'onready') }}}();
+    };
+    Fetch.openDatabase('emscripten_filesystem', 1, done, function() { done(false); });
+#else
+    {{{ makeDynCall('v', 'onready') }}}();
+#endif
+  },
+#endif
+
   emscripten_start_fetch: startFetch,
   emscripten_start_fetch__deps: [
     '$Fetch',
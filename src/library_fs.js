@@ -97,6 +97,12 @@ FS.staticInit();` +
     streams: [],
     nextInode: 1,
     nameTable: null,
+    // Results of lookupPath for absolute, normalized paths, with one table for
+    // each combination of the options that affect the result. Anything that
+    // can change what a path resolves to (removing or renaming a node,
+    // mounting and unmounting, or changing permissions) clears it.
+    lookupCache: [],
+    lookupCacheSize: 0,
     currentPath: '/',
     initialized: false,
     // Whether we are currently ignoring permissions. Useful when preparing the
@@ -116,47 +122,60 @@ FS.staticInit();` +
     // paths
     //
     lookupPath: function(path, opts) {
-      path = PATH_FS.resolve(FS.cwd(), path);
       opts = opts || {};
 
-      if (!path) return { path: '', node: null };
-
-      var defaults = {
-        follow_mount: true,
-        recurse_count: 0
-      };
-      for (var key in defaults) {
-        if (opts[key] === undefined) {
-          opts[key] = defaults[key];
-        }
+      // Most paths are already absolute and normalized, and can be walked
+      // as they are.  Anything else (relative paths, '.' and '..', repeated
+      // or trailing slashes) goes through PATH_FS.resolve first.
+      if (path.charAt(0) !== '/' || FS.unnormalizedPathRegex.test(path)) {
+        path = PATH_FS.resolve(FS.cwd(), path);
+        if (!path) return { path: '', node: null };
       }
 
-      if (opts.recurse_count > 8) {  // max recursive lookup of 8
+      var recurse_count = opts.recurse_count || 0;
+      if (recurse_count > 8) {  // max recursive lookup of 8
         throw new FS.ErrnoError({{{ cDefine('ELOOP') }}});
       }
 
-      // split the path
-      var parts = PATH.normalizeArray(path.split('/').filter(function(p) {
-        return !!p;
-      }), false);
+      // Permissions aren't checked while they are ignored, so results from
+      // then can't be reused.
+      var cache;
+      if (!recurse_count && !FS.ignorePermissions) {
+        var cacheIndex = (opts.parent ? 1 : 0) | (opts.follow ? 2 : 0) | (opts.follow_mount === false ? 4 : 0);
+        cache = FS.lookupCache[cacheIndex] || (FS.lookupCache[cacheIndex] = {});
+        var cached = cache[path];
+        if (cached) return cached;
+      }
 
       // start at the root
       var current = FS.root;
-      var current_path = '/';
-
-      for (var i = 0; i < parts.length; i++) {
-        var islast = (i === parts.length-1);
+      // The path walked so far is path.substring(0, end), unless a symlink was
+      // followed, in which case it is the symlink's target followed by
+      // path.substring(linkEnd, end).
+      var end = 0;
+      var linkPath = null;
+      var linkEnd = 0;
+      function currentPath() {
+        if (linkPath === null) return path.substring(0, end) || '/';
+        return ((linkPath === '/' ? '' : linkPath) + path.substring(linkEnd, end)) || '/';
+      }
+
+      while (end + 1 < path.length) {
+        var start = end + 1;
+        var next = path.indexOf('/', start);
+        if (next < 0) next = path.length;
+        var islast = next === path.length;
         if (islast && opts.parent) {
           // stop resolving
           break;
         }
 
-        current = FS.lookupNode(current, parts[i]);
-        current_path = PATH.join2(current_path, parts[i]);
+        current = FS.lookupNode(current, path.substring(start, next));
+        end = next;
 
         // jump to the mount's root node if this is a mountpoint
         if (FS.isMountpoint(current)) {
-          if (!islast || (islast && opts.follow_mount)) {
+          if (!islast || opts.follow_mount !== false) {
             current = current.mounted.root;
           }
         }
@@ -166,11 +185,14 @@ FS.staticInit();` +
         if (!islast || opts.follow) {
           var count = 0;
           while (FS.isLink(current.mode)) {
+            var current_path = currentPath();
             var link = FS.readlink(current_path);
             current_path = PATH_FS.resolve(PATH.dirname(current_path), link);
 
-            var lookup = FS.lookupPath(current_path, { recurse_count: opts.recurse_count });
+            var lookup = FS.lookupPath(current_path, { recurse_count: recurse_count });
             current = lookup.node;
+            linkPath = current_path;
+            linkEnd = end;
 
             if (count++ > 40) {  // limit max consecutive symlinks to 40 (SYMLOOP_MAX).
               throw new FS.ErrnoError({{{ cDefine('ELOOP') }}});
@@ -179,7 +201,23 @@ FS.staticInit();` +
         }
       }
 
-      return { path: current_path, node: current };
+      var result = { path: currentPath(), node: current };
+      if (cache) {
+        if (FS.lookupCacheSize++ > 4096) {
+          FS.clearLookupCache();
+          cache = FS.lookupCache[cacheIndex] = {};
+          FS.lookupCacheSize = 1;
+        }
+        cache[path] = result;
+      }
+      return result;
+    },
+    // Matches paths with '.' or '..' components, repeated slashes or a trailing
+    // slash.
+    unnormalizedPathRegex: /\/\.{0,2}(\/|$)/,
+    clearLookupCache: function() {
+      FS.lookupCache = [];
+      FS.lookupCacheSize = 0;
     },
     getPath: function(node) {
       var path;
@@ -215,6 +253,7 @@ FS.staticInit();` +
       FS.nameTable[hash] = node;
     },
     hashRemoveNode: function(node) {
+      FS.clearLookupCache();
       var hash = FS.hashName(node.parent.id, node.name);
       if (FS.nameTable[hash] === node) {
         FS.nameTable[hash] = node.name_next;
@@ -589,6 +628,7 @@ FS.staticInit();` +
       } else if (node) {
         // set as a mountpoint
         node.mounted = mount;
+        FS.clearLookupCache();
 
         // add the new mount to the current mount's children
         if (node.mount) {
@@ -626,6 +666,7 @@ FS.staticInit();` +
 
       // no longer a mountpoint
       node.mounted = null;
+      FS.clearLookupCache();
 
       // remove this mount from the child mounts
       var idx = node.mount.mounts.indexOf(mount);
@@ -920,6 +961,7 @@ FS.staticInit();` +
         mode: (mode & {{{ cDefine('S_IALLUGO') }}}) | (node.mode & ~{{{ cDefine('S_IALLUGO') }}}),
         timestamp: Date.now()
       });
+      FS.clearLookupCache();
     },
     lchmod: function(path, mode) {
       FS.chmod(path, mode, true);
@@ -1272,8 +1314,11 @@ FS.staticInit();` +
       }
       return stream.stream_ops.msync(stream, buffer, offset, length, mmapFlags);
     },
-    munmap: function(stream) {
-      return 0;
+    munmap: function(stream, mmapFlags) {
+      if (!stream.stream_ops.munmap) {
+        return 0;
+      }
+      return stream.stream_ops.munmap(stream, mmapFlags);
     },
     ioctl: function(stream, cmd, arg) {
       if (!stream.stream_ops.ioctl) {
@@ -197,6 +197,78 @@ var LibraryHTML5 = {
         __emscripten_call_on_thread(0, targetThread, {{{ cDefine('EM_FUNC_SIG_IIII') }}}, eventHandlerFunc, eventData, varargs);
       });
     },
+
+    // High frequency events are sent to their threads through a ring of
+    // events in shared memory, one per target thread, which the thread drains
+    // in one pass (see system/lib/pthread/html5_event_ring.h for the layout).
+    // beginEventOnThread returns the address to write the event struct to,
+    // and endEventOnThread publishes it.  If canCoalesce is given and the last
+    // event in the ring is for the same callback and has not been picked up
+    // yet, canCoalesce(pendingEvent) may allow the new event to be merged into
+    // it instead, in which case JSEvents.eventCoalesced is set and the address
+    // returned is that of the pending event.  If the ring is full, the event
+    // is malloc'd and queued as a call as usual.
+    eventRings: {},
+    eventRing: 0,
+    eventRingEntry: 0,
+    eventRingEntryIsNew: false,
+    eventCoalesced: false,
+    eventRingEntryAddress: function(ring, index) {
+      return ring + {{{ C_STRUCTS.html5_event_ring.entries }}} + (index & {{{ cDefine('EM_HTML5_EVENT_RING_CAPACITY') - 1 }}}) * {{{ C_STRUCTS.html5_event_ring_entry.__size__ }}};
+    },
+    beginEventOnThread: function(targetThread, callbackfunc, eventTypeId, userData, eventSize, canCoalesce) {
+      JSEvents.eventRingEntry = 0;
+      JSEvents.eventCoalesced = false;
+      var ring = JSEvents.eventRings[targetThread] || (JSEvents.eventRings[targetThread] = __emscripten_html5_event_ring_create(targetThread));
+      if (!ring) return _malloc(eventSize);
+      var head = Atomics.load(HEAPU32, (ring + {{{ C_STRUCTS.html5_event_ring.head }}}) >> 2);
+      var tail = Atomics.load(HEAPU32, (ring + {{{ C_STRUCTS.html5_event_ring.tail }}}) >> 2);
+      var entry;
+      if (canCoalesce && head != tail) {
+        entry = JSEvents.eventRingEntryAddress(ring, head - 1);
+        if ({{{ makeGetValue('entry', C_STRUCTS.html5_event_ring_entry.eventType, 'i32') }}} == eventTypeId
+          && {{{ makeGetValue('entry', C_STRUCTS.html5_event_ring_entry.callback, 'i32') }}} == callbackfunc
+          && {{{ makeGetValue('entry', C_STRUCTS.html5_event_ring_entry.userData, 'i32') }}} == userData
+          // Take the entry from READY to WRITING, unless the thread has already taken it.
+          && Atomics.compareExchange(HEAP32, (entry + {{{ C_STRUCTS.html5_event_ring_entry.state }}}) >> 2, {{{ cDefine('EM_HTML5_EVENT_ENTRY_READY') }}}, {{{ cDefine('EM_HTML5_EVENT_ENTRY_WRITING') }}}) == {{{ cDefine('EM_HTML5_EVENT_ENTRY_READY') }}}) {
+          if (canCoalesce(entry + {{{ C_STRUCTS.html5_event_ring_entry.data }}})) {
+            JSEvents.eventRing = ring;
+            JSEvents.eventRingEntry = entry;
+            JSEvents.eventRingEntryIsNew = false;
+            JSEvents.eventCoalesced = true;
+            return entry + {{{ C_STRUCTS.html5_event_ring_entry.data }}};
+          }
+          Atomics.store(HEAP32, (entry + {{{ C_STRUCTS.html5_event_ring_entry.state }}}) >> 2, {{{ cDefine('EM_HTML5_EVENT_ENTRY_READY') }}});
+        }
+      }
+      if (((head - tail) >>> 0) >= {{{ cDefine('EM_HTML5_EVENT_RING_CAPACITY') }}}) {
+        // The thread is not keeping up.
+        return _malloc(eventSize);
+      }
+      entry = JSEvents.eventRingEntryAddress(ring, head);
+      {{{ makeSetValue('entry', C_STRUCTS.html5_event_ring_entry.eventType, 'eventTypeId', 'i32') }}};
+      {{{ makeSetValue('entry', C_STRUCTS.html5_event_ring_entry.callback, 'callbackfunc', 'i32') }}};
+      {{{ makeSetValue('entry', C_STRUCTS.html5_event_ring_entry.userData, 'userData', 'i32') }}};
+      JSEvents.eventRing = ring;
+      JSEvents.eventRingEntry = entry;
+      JSEvents.eventRingEntryIsNew = true;
+      return entry + {{{ C_STRUCTS.html5_event_ring_entry.data }}};
+    },
+    endEventOnThread: function(targetThread, callbackfunc, eventTypeId, eventData, userData) {
+      var entry = JSEvents.eventRingEntry;
+      if (!entry) {
+        JSEvents.queueEventHandlerOnThread_iiii(targetThread, callbackfunc, eventTypeId, eventData, userData);
+        return;
+      }
+      Atomics.store(HEAP32, (entry + {{{ C_STRUCTS.html5_event_ring_entry.state }}}) >> 2, {{{ cDefine('EM_HTML5_EVENT_ENTRY_READY') }}});
+      if (JSEvents.eventRingEntryIsNew) {
+        var ring = JSEvents.eventRing;
+        Atomics.add(HEAPU32, (ring + {{{ C_STRUCTS.html5_event_ring.head }}}) >> 2, 1);
+        // Queue a drain, unless one is already queued and yet to read the head.
+        if (!Atomics.exchange(HEAP32, (ring + {{{ C_STRUCTS.html5_event_ring.drain_queued }}}) >> 2, 1)) __emscripten_html5_event_ring_queue_drain(ring);
+      }
+      JSEvents.eventRingEntry = 0;
+    },
 #endif
 
 #if USE_PTHREADS
@@ -248,7 +320,7 @@ var LibraryHTML5 = {
 #endif
 
 #if USE_PTHREADS
-      var keyEventData = targetThread ? _malloc( {{{ C_STRUCTS.EmscriptenKeyboardEvent.__size__ }}} ) : JSEvents.keyEvent; // This allocated block is passed as satellite data to the proxied function call, so the call frees up the data block when done.
+      var keyEventData = targetThread ? JSEvents.beginEventOnThread(targetThread, callbackfunc, eventTypeId, userData, {{{ C_STRUCTS.EmscriptenKeyboardEvent.__size__ }}}) : JSEvents.keyEvent;
 #else
       var keyEventData = JSEvents.keyEvent;
 #endif
@@ -271,7 +343,7 @@ var LibraryHTML5 = {
       stringToUTF8(e.locale || '', keyEventData + {{{ C_STRUCTS.EmscriptenKeyboardEvent.locale }}}, {{{ cDefine('EM_HTML5_SHORT_STRING_LEN_BYTES') }}});
 
 #if USE_PTHREADS
-      if (targetThread) JSEvents.queueEventHandlerOnThread_iiii(targetThread, callbackfunc, eventTypeId, keyEventData, userData);
+      if (targetThread) JSEvents.endEventOnThread(targetThread, callbackfunc, eventTypeId, keyEventData, userData);
       else
 #endif
       if ({{{ makeDynCall('iiii', 'callbackfunc') }}}(eventTypeId, keyEventData, userData)) e.preventDefault();
@@ -513,6 +585,10 @@ var LibraryHTML5 = {
 #endif
     if (!JSEvents.mouseEvent) JSEvents.mouseEvent = _malloc( {{{ C_STRUCTS.EmscriptenMouseEvent.__size__ }}} );
     target = findEventTarget(target);
+#if USE_PTHREADS
+    // Consecutive mousemoves can be merged, adding up their movement.
+    var canCoalesce = eventTypeString == 'mousemove' ? function() { return true; } : null;
+#endif
 
     var mouseEventHandlerFunc = function(ev) {
       var e = ev || event;
@@ -522,9 +598,14 @@ var LibraryHTML5 = {
 
 #if USE_PTHREADS
       if (targetThread) {
-        var mouseEventData = _malloc( {{{ C_STRUCTS.EmscriptenMouseEvent.__size__ }}} ); // This allocated block is passed as satellite data to the proxied function call, so the call frees up the data block when done.
+        var mouseEventData = JSEvents.beginEventOnThread(targetThread, callbackfunc, eventTypeId, userData, {{{ C_STRUCTS.EmscriptenMouseEvent.__size__ }}}, canCoalesce);
+        var idx = mouseEventData >> 2;
+        var movementX = JSEvents.eventCoalesced ? HEAP32[idx + {{{ C_STRUCTS.EmscriptenMouseEvent.movementX / 4 }}}] : 0;
+        var movementY = JSEvents.eventCoalesced ? HEAP32[idx + {{{ C_STRUCTS.EmscriptenMouseEvent.movementY / 4 }}}] : 0;
         fillMouseEventData(mouseEventData, e, target);
-        JSEvents.queueEventHandlerOnThread_iiii(targetThread, callbackfunc, eventTypeId, mouseEventData, userData);
+        HEAP32[idx + {{{ C_STRUCTS.EmscriptenMouseEvent.movementX / 4 }}}] += movementX;
+        HEAP32[idx + {{{ C_STRUCTS.EmscriptenMouseEvent.movementY / 4 }}}] += movementY;
+        JSEvents.endEventOnThread(targetThread, callbackfunc, eventTypeId, mouseEventData, userData);
       } else
 #endif
       if ({{{ makeDynCall('iiii', 'callbackfunc') }}}(eventTypeId, JSEvents.mouseEvent, userData)) e.preventDefault();
@@ -637,22 +718,44 @@ var LibraryHTML5 = {
     targetThread = JSEvents.getTargetThreadForEventCallback(targetThread);
 #endif
     if (!JSEvents.wheelEvent) JSEvents.wheelEvent = _malloc( {{{ C_STRUCTS.EmscriptenWheelEvent.__size__ }}} );
+#if USE_PTHREADS
+    // Consecutive wheel events can be merged, adding up their deltas, as long
+    // as they are in the same units.
+    var deltaMode;
+    var canCoalesce = function(pendingEvent) {
+      return {{{ makeGetValue('pendingEvent', C_STRUCTS.EmscriptenWheelEvent.deltaMode, 'i32') }}} == deltaMode;
+    };
+#endif
 
     // The DOM Level 3 events spec event 'wheel'
     var wheelHandlerFunc = function(ev) {
       var e = ev || event;
 #if USE_PTHREADS
-      var wheelEvent = targetThread ? _malloc( {{{ C_STRUCTS.EmscriptenWheelEvent.__size__ }}} ) : JSEvents.wheelEvent; // This allocated block is passed as satellite data to the proxied function call, so the call frees up the data block when done.
+      var deltaX = 0, deltaY = 0, deltaZ = 0;
+      var wheelEvent = JSEvents.wheelEvent;
+      if (targetThread) {
+        deltaMode = e["deltaMode"];
+        wheelEvent = JSEvents.beginEventOnThread(targetThread, callbackfunc, eventTypeId, userData, {{{ C_STRUCTS.EmscriptenWheelEvent.__size__ }}}, canCoalesce);
+        if (JSEvents.eventCoalesced) {
+          deltaX = {{{ makeGetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaX, 'double') }}};
+          deltaY = {{{ makeGetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaY, 'double') }}};
+          deltaZ = {{{ makeGetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaZ, 'double') }}};
+        }
+      }
+      fillMouseEventData(wheelEvent, e, target);
+      {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaX, 'deltaX + e["deltaX"]', 'double') }}};
+      {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaY, 'deltaY + e["deltaY"]', 'double') }}};
+      {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaZ, 'deltaZ + e["deltaZ"]', 'double') }}};
 #else
       var wheelEvent = JSEvents.wheelEvent;
-#endif
       fillMouseEventData(wheelEvent, e, target);
       {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaX, 'e["deltaX"]', 'double') }}};
       {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaY, 'e["deltaY"]', 'double') }}};
       {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaZ, 'e["deltaZ"]', 'double') }}};
+#endif
       {{{ makeSetValue('wheelEvent', C_STRUCTS.EmscriptenWheelEvent.deltaMode, 'e["deltaMode"]', 'i32') }}};
 #if USE_PTHREADS
-      if (targetThread) JSEvents.queueEventHandlerOnThread_iiii(targetThread, callbackfunc, eventTypeId, wheelEvent, userData);
+      if (targetThread) JSEvents.endEventOnThread(targetThread, callbackfunc, eventTypeId, wheelEvent, userData);
       else
 #endif
       if ({{{ makeDynCall('iiii', 'callbackfunc') }}}(eventTypeId, wheelEvent, userData)) e.preventDefault();
@@ -726,6 +829,9 @@ var LibraryHTML5 = {
       target = findEventTarget(target);
     }
 #else
+#endif
+#if USE_PTHREADS
+    var canCoalesce = function() { return true; };
 #endif
 
     var uiEventHandlerFunc = function(ev) {
@@ -743,7 +849,8 @@ var LibraryHTML5 = {
         return;
       }
 #if USE_PTHREADS
-      var uiEvent = targetThread ? _malloc( {{{ C_STRUCTS.EmscriptenUiEvent.__size__ }}} ) : JSEvents.uiEvent;
+      // Only the latest state matters, so a pending event is simply updated.
+      var uiEvent = targetThread ? JSEvents.beginEventOnThread(targetThread, callbackfunc, eventTypeId, userData, {{{ C_STRUCTS.EmscriptenUiEvent.__size__ }}}, canCoalesce) : JSEvents.uiEvent;
 #else
       var uiEvent = JSEvents.uiEvent;
 #endif
@@ -757,7 +864,7 @@ var LibraryHTML5 = {
       {{{ makeSetValue('uiEvent', C_STRUCTS.EmscriptenUiEvent.scrollTop, 'pageXOffset', 'i32') }}};
       {{{ makeSetValue('uiEvent', C_STRUCTS.EmscriptenUiEvent.scrollLeft, 'pageYOffset', 'i32') }}};
 #if USE_PTHREADS
-      if (targetThread) JSEvents.queueEventHandlerOnThread_iiii(targetThread, callbackfunc, eventTypeId, uiEvent, userData);
+      if (targetThread) JSEvents.endEventOnThread(targetThread, callbackfunc, eventTypeId, uiEvent, userData);
       else
 #endif
       if ({{{ makeDynCall('iiii', 'callbackfunc') }}}(eventTypeId, uiEvent, userData)) e.preventDefault();
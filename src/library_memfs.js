@@ -5,7 +5,11 @@
  */
 
 mergeInto(LibraryManager.library, {
-  $MEMFS__deps: ['$FS', '$mmapAlloc'],
+  $MEMFS__deps: ['$FS', '$mmapAlloc',
+#if MEMFS_SHARED_MMAP
+    '$alignMemory',
+#endif
+  ],
   $MEMFS: {
     ops_table: null,
     mount: function(mount) {
@@ -45,7 +49,10 @@ mergeInto(LibraryManager.library, {
               write: MEMFS.stream_ops.write,
               allocate: MEMFS.stream_ops.allocate,
               mmap: MEMFS.stream_ops.mmap,
-              msync: MEMFS.stream_ops.msync
+              msync: MEMFS.stream_ops.msync,
+#if MEMFS_SHARED_MMAP
+              munmap: MEMFS.stream_ops.munmap
+#endif
             }
           },
           link: {
@@ -97,6 +104,9 @@ mergeInto(LibraryManager.library, {
     // Given a file node, returns its file data converted to a typed array.
     getFileDataAsTypedArray: function(node) {
       if (!node.contents) return new Uint8Array(0);
+#if MEMFS_SHARED_MMAP
+      MEMFS.updateHeapView(node);
+#endif
       if (node.contents.subarray) return node.contents.subarray(0, node.usedBytes); // Make sure to not return excess unused bytes.
       return new Uint8Array(node.contents);
     },
@@ -107,6 +117,14 @@ mergeInto(LibraryManager.library, {
     expandFileStorage: function(node, newCapacity) {
 #if CAN_ADDRESS_2GB
       newCapacity >>>= 0;
+#endif
+#if MEMFS_SHARED_MMAP
+      if (node.heapPtr) {
+        // Moving the file to a larger region would leave the mappings pointing
+        // at a stale copy.
+        if (node.heapCapacity < newCapacity) throw new FS.ErrnoError({{{ cDefine('ENOSPC') }}});
+        return;
+      }
 #endif
       var prevCapacity = node.contents ? node.contents.length : 0;
       if (prevCapacity >= newCapacity) return; // No need to expand, the storage was already large enough.
@@ -127,6 +145,18 @@ mergeInto(LibraryManager.library, {
       newSize >>>= 0;
 #endif
       if (node.usedBytes == newSize) return;
+#if MEMFS_SHARED_MMAP
+      if (node.heapPtr) {
+        // The heap region stays in place for the mappings that point into it.
+        // Bytes past the end of the file are kept zeroed, so that growing it
+        // again reads back zeros.
+        MEMFS.expandFileStorage(node, newSize);
+        MEMFS.updateHeapView(node);
+        if (newSize < node.usedBytes) node.contents.fill(0, newSize, node.usedBytes);
+        node.usedBytes = newSize;
+        return;
+      }
+#endif
       if (newSize == 0) {
         node.contents = null; // Fully decommit when requesting a resize to zero.
         node.usedBytes = 0;
@@ -140,6 +170,46 @@ mergeInto(LibraryManager.library, {
       }
     },
 
+#if MEMFS_SHARED_MMAP
+    // While a file has shared mappings its contents live in the heap, at
+    // node.heapPtr, and node.contents is a view of that region.  Moves the
+    // contents to a heap region of at least the given capacity.  The file stays
+    // in that region until the last mapping goes away, and can't grow past it.
+    moveFileToHeap: function(node, capacity) {
+      capacity = alignMemory(Math.max(capacity, node.usedBytes), {{{ WASM_PAGE_SIZE }}});
+      var ptr = mmapAlloc(capacity);
+      if (!ptr) {
+        throw new FS.ErrnoError({{{ cDefine('ENOMEM') }}});
+      }
+#if CAN_ADDRESS_2GB
+      ptr >>>= 0;
+#endif
+      if (node.usedBytes) HEAPU8.set(MEMFS.getFileDataAsTypedArray(node), ptr);
+      node.heapPtr = ptr;
+      node.heapCapacity = capacity;
+      node.contents = HEAPU8.subarray(ptr, ptr + capacity);
+    },
+
+    // Once the last shared mapping is gone, copies the contents back out of
+    // the heap and frees the heap memory.
+    moveFileFromHeap: function(node) {
+      var ptr = node.heapPtr;
+      node.contents = node.usedBytes ? HEAPU8.slice(ptr, ptr + node.usedBytes) : null;
+      _free(ptr);
+      node.heapPtr = 0;
+      node.heapCapacity = 0;
+    },
+
+    // Memory growth replaces the heap's buffer, which leaves earlier views of
+    // it detached, and node.contents may have been replaced with a view of
+    // just the used bytes (see getFileDataAsTypedArray's callers).
+    updateHeapView: function(node) {
+      if (node.heapPtr && (node.contents.buffer !== HEAPU8.buffer || node.contents.length !== node.heapCapacity)) {
+        node.contents = HEAPU8.subarray(node.heapPtr, node.heapPtr + node.heapCapacity);
+      }
+    },
+#endif
+
     node_ops: {
       getattr: function(node) {
         var attr = {};
@@ -244,6 +314,9 @@ mergeInto(LibraryManager.library, {
     },
     stream_ops: {
       read: function(stream, buffer, offset, length, position) {
+#if MEMFS_SHARED_MMAP
+        MEMFS.updateHeapView(stream.node);
+#endif
         var contents = stream.node.contents;
         if (position >= stream.node.usedBytes) return 0;
         var size = Math.min(stream.node.usedBytes - position, length);
@@ -283,6 +356,17 @@ mergeInto(LibraryManager.library, {
         var node = stream.node;
         node.timestamp = Date.now();
 
+#if MEMFS_SHARED_MMAP
+        if (node.heapPtr) {
+          // The data must be written in place, where the mappings can see it.
+          MEMFS.expandFileStorage(node, position + length);
+          MEMFS.updateHeapView(node);
+          node.contents.set(buffer.subarray ? buffer.subarray(offset, offset + length) : buffer.slice(offset, offset + length), position);
+          node.usedBytes = Math.max(node.usedBytes, position + length);
+          return length;
+        }
+#endif
+
         if (buffer.subarray && (!node.contents || node.contents.subarray)) { // This write is from a typed array to a typed array?
           if (canOwn) {
 #if ASSERTIONS
@@ -343,6 +427,21 @@ mergeInto(LibraryManager.library, {
         }
         var ptr;
         var allocated;
+#if MEMFS_SHARED_MMAP
+        if (!(flags & {{{ cDefine('MAP_PRIVATE') }}})) {
+          var node = stream.node;
+          if (!node.heapPtr) {
+            MEMFS.moveFileToHeap(node, position + length);
+          } else if (position + length > node.heapCapacity) {
+            // Moving the file to a larger region would leave the existing
+            // mappings pointing at a stale copy.
+            throw new FS.ErrnoError({{{ cDefine('ENOMEM') }}});
+          }
+          node.heapMappings = (node.heapMappings || 0) + 1;
+          return { ptr: node.heapPtr + position, allocated: false };
+        }
+        MEMFS.updateHeapView(stream.node);
+#endif
         var contents = stream.node.contents;
         // Only make a new copy when MAP_PRIVATE is specified.
         if (!(flags & {{{ cDefine('MAP_PRIVATE') }}}) && contents.buffer === buffer) {
@@ -359,6 +458,11 @@ mergeInto(LibraryManager.library, {
               contents = Array.prototype.slice.call(contents, position, position + length);
             }
           }
+          // The contents may be a view of the heap (e.g. for a file that also has
+          // shared mappings), which mmapAlloc can grow, detaching the view.
+          if (contents.buffer === HEAP8.buffer) {
+            contents = contents.slice();
+          }
           allocated = true;
           ptr = mmapAlloc(length);
           if (!ptr) {
@@ -383,7 +487,16 @@ mergeInto(LibraryManager.library, {
         var bytesWritten = MEMFS.stream_ops.write(stream, buffer, 0, length, offset, false);
         // should we check if bytesWritten and length are the same?
         return 0;
+      },
+#if MEMFS_SHARED_MMAP
+      munmap: function(stream, mmapFlags) {
+        var node = stream.node;
+        if (!(mmapFlags & {{{ cDefine('MAP_PRIVATE') }}}) && node.heapPtr && --node.heapMappings === 0) {
+          MEMFS.moveFileFromHeap(node);
+        }
+        return 0;
       }
+#endif
     }
   }
 });
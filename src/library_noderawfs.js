@@ -164,7 +164,11 @@ mergeInto(LibraryManager.library, {
       FS.write(stream, buffer, 0, length, offset);
       return 0;
     },
-    munmap: function() {
+    munmap: function(stream, mmapFlags) {
+      if (stream.stream_ops) {
+        // this stream is created by in-memory filesystem
+        return VFS.munmap(stream, mmapFlags);
+      }
       return 0;
     },
     ioctl: function() {
@@ -13,6 +13,12 @@ var LibraryPThread = {
                    'exit',
 #if !MINIMAL_RUNTIME
                    '$handleException',
+#endif
+#if MAIN_MODULE
+                   '$LDSO',
+#endif
+#if PTHREADS_PROFILING
+                   'emscripten_main_browser_thread_id',
 #endif
                    ],
   $PThread: {
@@ -37,7 +43,48 @@ var LibraryPThread = {
         PThread.allocateUnusedWorker();
       }
 #endif
+#if PTHREAD_POOL_IDLE_TIMEOUT && PTHREAD_POOL_SIZE
+      PThread.minUnusedWorkers = Math.max(PThread.minUnusedWorkers, pthreadPoolSize);
+#endif
+    },
+
+#if PTHREAD_POOL_LOW_WATER
+    poolRefillQueued: false,
+    // Tops the pool back up to PTHREAD_POOL_LOW_WATER unused Workers. This is
+    // done from the event loop, so that creating and loading the new Workers
+    // never delays the pthread_create() that used up an existing one.
+    queuePoolRefill: function() {
+      if (PThread.poolRefillQueued) return;
+      PThread.poolRefillQueued = true;
+      setTimeout(function() {
+        PThread.poolRefillQueued = false;
+        if (ABORT || runtimeExited) return;
+        while (PThread.unusedWorkers.length < {{{ PTHREAD_POOL_LOW_WATER }}}) {
+          PThread.allocateUnusedWorker();
+          // Keep Workers that are still loading at the front of the pool, so
+          // that getNewWorker() hands out ones that are ready first.
+          var worker = PThread.unusedWorkers.pop();
+          PThread.unusedWorkers.unshift(worker);
+          PThread.loadWasmModuleToWorker(worker);
+        }
+      }, 0);
+    },
+#endif
+
+#if PTHREAD_POOL_IDLE_TIMEOUT
+    // Idle Workers are only retired while the pool has more than this many.
+    minUnusedWorkers: {{{ PTHREAD_POOL_LOW_WATER }}},
+    retireIdleWorker: function(worker) {
+      worker.retireTimer = undefined;
+      var index = PThread.unusedWorkers.indexOf(worker);
+      if (index < 0 || PThread.unusedWorkers.length <= PThread.minUnusedWorkers) return;
+#if PTHREADS_DEBUG
+      err('retiring idle worker');
+#endif
+      PThread.unusedWorkers.splice(index, 1);
+      worker.terminate();
     },
+#endif
 
     initWorker: function() {
 #if USE_CLOSURE_COMPILER
@@ -60,7 +107,7 @@ var LibraryPThread = {
 
       // Zero fill contents at startup.
       for (var i = 0; i < {{{ C_STRUCTS.thread_profiler_block.__size__ }}}; i += 4) Atomics.store(HEAPU32, (profilerBlock + i) >> 2, 0);
-      Atomics.store(HEAPU32, (profilerBlock + {{{ C_STRUCTS.thread_profiler_block.currentStatusStartTime }}} ) >> 2, performance.now());
+      HEAPF64[(profilerBlock + {{{ C_STRUCTS.thread_profiler_block.currentStatusStartTime }}} ) >> 3] = performance.now();
     },
 
     // Sets the current thread status, but only if it was in the given expected state before. This is used
@@ -117,6 +164,143 @@ var LibraryPThread = {
       var status = (profilerBlock == 0) ? 0 : Atomics.load(HEAPU32, (profilerBlock + {{{ C_STRUCTS.thread_profiler_block.threadStatus }}} ) >> 2);
       return PThread.threadStatusToString(status);
     },
+
+    // Accumulates a blocking wait on the given futex address into the calling
+    // thread's profiler block. Once all the slots are in use, an address only
+    // replaces the one with the least total wait time if this single wait was
+    // longer than that, so the table keeps the most contended addresses.
+    recordFutexWait: function(addr, duration) {
+      var profilerBlock = Atomics.load(HEAPU32, (_pthread_self() + {{{ C_STRUCTS.pthread.profilerBlock }}} ) >> 2);
+      if (!profilerBlock) return;
+      var addresses = (profilerBlock + {{{ C_STRUCTS.thread_profiler_block.futexAddress }}} ) >> 2;
+      var counts = (profilerBlock + {{{ C_STRUCTS.thread_profiler_block.futexWaitCount }}} ) >> 2;
+      var times = (profilerBlock + {{{ C_STRUCTS.thread_profiler_block.futexWaitTime }}} ) >> 3;
+      var slot = 0;
+      for (var i = 0; i < {{{ cDefine('EM_THREAD_PROFILER_MAX_FUTEXES') }}}; ++i) {
+        if (HEAPU32[addresses + i] == addr || !HEAPU32[addresses + i]) {
+          slot = i;
+          break;
+        }
+        if (HEAPF64[times + i] < HEAPF64[times + slot]) slot = i;
+      }
+      if (HEAPU32[addresses + slot] != addr) {
+        if (HEAPU32[addresses + slot] && HEAPF64[times + slot] >= duration) return;
+        HEAPU32[addresses + slot] = addr;
+        HEAPU32[counts + slot] = 0;
+        HEAPF64[times + slot] = 0;
+      }
+      HEAPU32[counts + slot]++;
+      HEAPF64[times + slot] += duration;
+    },
+
+    // Keys for the EM_THREAD_STATUS_* values in profile reports.
+    threadStatusKeys: ['notStarted', 'running', 'sleeping', 'waitFutex', 'waitMutex', 'waitProxy', 'finished'],
+
+    // Returns the profiling data of the given thread as a plain object that
+    // can be serialized with JSON.stringify(), or null if the thread has no
+    // profiler block.
+    getThreadProfile: function(pthreadPtr) {
+      var profilerBlock = Atomics.load(HEAPU32, (pthreadPtr + {{{ C_STRUCTS.pthread.profilerBlock }}} ) >> 2);
+      if (!profilerBlock) return null;
+      var status = Atomics.load(HEAPU32, (profilerBlock + {{{ C_STRUCTS.thread_profiler_block.threadStatus }}} ) >> 2);
+      var timeInStatus = {};
+      for (var i = 0; i < {{{ cDefine('EM_THREAD_STATUS_NUMFIELDS') }}}; ++i) {
+        timeInStatus[PThread.threadStatusKeys[i]] = HEAPF64[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.timeSpentInStatus }}} ) >> 3) + i];
+      }
+      // Include the time spent so far in the current status.
+      timeInStatus[PThread.threadStatusKeys[status]] += Math.max(0, performance.now() - HEAPF64[(profilerBlock + {{{ C_STRUCTS.thread_profiler_block.currentStatusStartTime }}} ) >> 3]);
+
+      var futexes = [];
+      for (var i = 0; i < {{{ cDefine('EM_THREAD_PROFILER_MAX_FUTEXES') }}}; ++i) {
+        var addr = HEAPU32[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.futexAddress }}} ) >> 2) + i];
+        if (!addr) break;
+        futexes.push({
+          'address': addr,
+          'waits': HEAPU32[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.futexWaitCount }}} ) >> 2) + i],
+          'waitTime': HEAPF64[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.futexWaitTime }}} ) >> 3) + i]
+        });
+      }
+      futexes.sort(function(a, b) { return b['waitTime'] - a['waitTime']; });
+
+      var proxiedCalls = [];
+      for (var i = 0; i < {{{ cDefine('EM_THREAD_PROFILER_MAX_PROXIED_CALLS') }}}; ++i) {
+        var latency = HEAPF64[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.proxiedCallLatency }}} ) >> 3) + i];
+        if (!latency) continue;
+        var call = {
+          'signature': HEAP32[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.proxiedCallSignature }}} ) >> 2) + i],
+          'function': HEAPU32[((profilerBlock + {{{ C_STRUCTS.thread_profiler_block.proxiedCallFunction }}} ) >> 2) + i],
+          'latency': latency
+        };
+        // Calls to JS library functions are identified by their index in
+        // proxiedFunctionTable.
+        if (call['signature'] == {{{ cDefine('EM_PROXIED_JS_FUNCTION') }}} && proxiedFunctionTable[call['function']]) {
+          call['name'] = proxiedFunctionTable[call['function']].name;
+        }
+        proxiedCalls.push(call);
+      }
+      proxiedCalls.sort(function(a, b) { return b['latency'] - a['latency']; });
+
+      return {
+        'thread': pthreadPtr,
+        'name': PThread.getThreadName(pthreadPtr),
+        'status': PThread.threadStatusKeys[status],
+        'timeInStatus': timeInStatus,
+        'futexes': futexes,
+        'proxiedCalls': proxiedCalls
+      };
+    },
+
+    // Profiles of threads that have exited, saved before their profiler
+    // blocks are freed.
+    exitedThreadProfiles: [],
+
+    saveThreadProfile: function(pthreadPtr) {
+      var profile = PThread.getThreadProfile(pthreadPtr);
+      if (profile) PThread.exitedThreadProfiles.push(profile);
+    },
+
+    // Returns a report of every thread that has run so far, together with the
+    // futex addresses that all threads have spent the most time waiting on
+    // combined, and the slowest proxied calls of any thread. All times are in
+    // milliseconds.
+    getProfileReport: function() {
+      var threads = PThread.exitedThreadProfiles.slice();
+      var live = [_emscripten_main_browser_thread_id()];
+      for (var t in PThread.pthreads) live.push(PThread.pthreads[t].threadInfoStruct);
+      for (var i = 0; i < live.length; ++i) {
+        var profile = PThread.getThreadProfile(live[i]);
+        if (profile) threads.push(profile);
+      }
+
+      var futexesByAddress = {};
+      var futexes = [];
+      var proxiedCalls = [];
+      threads.forEach(function(thread) {
+        thread['futexes'].forEach(function(futex) {
+          var total = futexesByAddress[futex['address']];
+          if (!total) {
+            total = futexesByAddress[futex['address']] = { 'address': futex['address'], 'waits': 0, 'waitTime': 0, 'threads': 0 };
+            futexes.push(total);
+          }
+          total['waits'] += futex['waits'];
+          total['waitTime'] += futex['waitTime'];
+          total['threads']++;
+        });
+        thread['proxiedCalls'].forEach(function(call) {
+          var entry = { 'thread': thread['thread'] };
+          for (var key in call) entry[key] = call[key];
+          proxiedCalls.push(entry);
+        });
+      });
+      futexes.sort(function(a, b) { return b['waitTime'] - a['waitTime']; });
+      proxiedCalls.sort(function(a, b) { return b['latency'] - a['latency']; });
+
+      return {
+        'threads': threads,
+        'futexes': futexes.slice(0, {{{ cDefine('EM_THREAD_PROFILER_MAX_FUTEXES') }}}),
+        'proxiedCalls': proxiedCalls.slice(0, {{{ cDefine('EM_THREAD_PROFILER_MAX_PROXIED_CALLS') }}})
+      };
+    },
 #endif
 
 #if !MINIMAL_RUNTIME
@@ -151,6 +335,9 @@ var LibraryPThread = {
 #if ASSERTIONS
         // This Worker should not be hosting a pthread at this time.
         assert(!worker.pthread);
+#endif
+#if PTHREAD_POOL_IDLE_TIMEOUT
+        clearTimeout(worker.retireTimer);
 #endif
         worker.terminate();
       }
@@ -169,10 +356,18 @@ var LibraryPThread = {
         PThread.unusedWorkers.push(worker);
         PThread.runningWorkers.splice(PThread.runningWorkers.indexOf(worker), 1);
         // Not a running Worker anymore
+#if PTHREADS_PROFILING
+        PThread.saveThreadProfile(worker.pthread.threadInfoStruct);
+#endif
         __emscripten_thread_free_data(worker.pthread.threadInfoStruct);
         // Detach the worker from the pthread object, and return it to the
         // worker pool as an unused worker.
         worker.pthread = undefined;
+#if PTHREAD_POOL_IDLE_TIMEOUT
+        worker.retireTimer = setTimeout(function() {
+          PThread.retireIdleWorker(worker);
+        }, {{{ PTHREAD_POOL_IDLE_TIMEOUT }}});
+#endif
       });
     },
     // Runs a function with processing of queued calls to the main thread
@@ -349,6 +544,9 @@ var LibraryPThread = {
 #endif
 #if MAIN_MODULE
         'dynamicLibraries': Module['dynamicLibraries'],
+        // Side modules that have already been compiled on this thread, so
+        // that the worker only needs to instantiate them.
+        'compiledDylibs': LDSO.compiledModules,
 #endif
       });
     },
@@ -421,7 +619,15 @@ var LibraryPThread = {
         PThread.allocateUnusedWorker();
         PThread.loadWasmModuleToWorker(PThread.unusedWorkers[0]);
       }
-      return PThread.unusedWorkers.pop();
+      var worker = PThread.unusedWorkers.pop();
+#if PTHREAD_POOL_IDLE_TIMEOUT
+      clearTimeout(worker.retireTimer);
+      worker.retireTimer = undefined;
+#endif
+#if PTHREAD_POOL_LOW_WATER
+      PThread.queuePoolRefill();
+#endif
+      return worker;
     }
   },
 
@@ -438,6 +644,9 @@ var LibraryPThread = {
     var pthread = PThread.pthreads[pthread_ptr];
     delete PThread.pthreads[pthread_ptr];
     pthread.worker.terminate();
+#if PTHREADS_PROFILING
+    PThread.saveThreadProfile(pthread_ptr);
+#endif
     __emscripten_thread_free_data(pthread_ptr);
     // The worker was completely nuked (not just the pthread execution it was hosting), so remove it from running workers
     // but don't put it back to the pool.
@@ -841,17 +1050,30 @@ var LibraryPThread = {
   },
 
   // Returns 0 on success, or one of the values -ETIMEDOUT, -EWOULDBLOCK or -EINVAL on error.
-  emscripten_futex_wait__deps: ['emscripten_main_thread_process_queued_calls'],
+  emscripten_futex_wait__deps: ['emscripten_main_thread_process_queued_calls',
+#if MAIN_THREAD_ASYNC_WAITS
+    '$Asyncify',
+#endif
+  ],
   emscripten_futex_wait: function(addr, val, timeout) {
     if (addr <= 0 || addr > HEAP8.length || addr&3 != 0) return -{{{ cDefine('EINVAL') }}};
+#if MAIN_THREAD_ASYNC_WAITS
+    // When resuming from an asynchronous wait (see below), the result is the
+    // value passed to wakeUp().
+    if (Asyncify.state === Asyncify.State.Rewinding) {
+      return Asyncify.handleSleep();
+    }
+#endif
     // We can do a normal blocking wait anywhere but on the main browser thread.
     if (!ENVIRONMENT_IS_WEB) {
 #if PTHREADS_PROFILING
       PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
+      var waitStart = performance.now();
 #endif
       var ret = Atomics.wait(HEAP32, addr >> 2, val, timeout);
 #if PTHREADS_PROFILING
       PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}}, {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}});
+      if (ret !== 'not-equal') PThread.recordFutexWait(addr, performance.now() - waitStart);
 #endif
       if (ret === 'timed-out') return -{{{ cDefine('ETIMEDOUT') }}};
       if (ret === 'not-equal') return -{{{ cDefine('EWOULDBLOCK') }}};
@@ -863,9 +1085,43 @@ var LibraryPThread = {
         return -{{{ cDefine('EWOULDBLOCK') }}};
       }
 
+#if MAIN_THREAD_ASYNC_WAITS
+      // Rather than spinning, suspend the program and return to the event loop,
+      // which also handles proxied calls from pthreads in the meantime, until
+      // Atomics.waitAsync tells us the futex was notified. This is only
+      // possible if no other wait is already suspended, and if we are
+      // directly inside a call that may suspend: JS glue that calls into wasm
+      // (e.g. _malloc from allocateUTF8, or an event callback) expects the
+      // call to return synchronously, so it gets the spin below.
+      if (typeof Atomics.waitAsync === 'function' && Asyncify.state === Asyncify.State.Normal && !Asyncify.currData &&
+          Asyncify.exportCallStack.length === 1 && Asyncify.exportCanSleep) {
+        return Asyncify.handleSleep(function(wakeUp) {
+          var result = Atomics.waitAsync(HEAP32, addr >> 2, val, timeout);
+          if (!result.async) {
+            wakeUp(result.value === 'timed-out' ? -{{{ cDefine('ETIMEDOUT') }}} : -{{{ cDefine('EWOULDBLOCK') }}});
+            return;
+          }
+#if PTHREADS_PROFILING
+          PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
+          var waitStart = performance.now();
+#endif
+          result.value.then(function(value) {
+#if PTHREADS_PROFILING
+            PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}}, {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}});
+            PThread.recordFutexWait(addr, performance.now() - waitStart);
+#endif
+            wakeUp(value === 'timed-out' ? -{{{ cDefine('ETIMEDOUT') }}} : 0);
+          });
+        });
+      }
+#endif
+
       // Atomics.wait is not available in the main browser thread, so simulate it via busy spinning.
       var tNow = performance.now();
       var tEnd = tNow + timeout;
+#if PTHREADS_PROFILING
+      var tStart = tNow;
+#endif
 
 #if PTHREADS_PROFILING
       PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
@@ -896,7 +1152,8 @@ var LibraryPThread = {
         tNow = performance.now();
         if (tNow > tEnd) {
 #if PTHREADS_PROFILING
-          PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
+          PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}}, {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}});
+          PThread.recordFutexWait(addr, tNow - tStart);
 #endif
           // We timed out, so stop marking ourselves as waiting.
           lastAddr = Atomics.exchange(HEAP32, __emscripten_main_thread_futex >> 2, 0);
@@ -958,6 +1215,10 @@ var LibraryPThread = {
         // was the same as calling emscripten_main_thread_process_queued_calls()
         // a few times times before calling emscripten_futex_wait().
         if (Atomics.load(HEAP32, addr >> 2) != val) {
+#if PTHREADS_PROFILING
+          PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}}, {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}});
+          PThread.recordFutexWait(addr, performance.now() - tStart);
+#endif
           return -{{{ cDefine('EWOULDBLOCK') }}};
         }
 
@@ -968,12 +1229,26 @@ var LibraryPThread = {
 #endif
       }
 #if PTHREADS_PROFILING
-      PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}}, {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}});
+      PThread.setThreadStatusConditional(_pthread_self(), {{{ cDefine('EM_THREAD_STATUS_WAITFUTEX') }}}, {{{ cDefine('EM_THREAD_STATUS_RUNNING') }}});
+      PThread.recordFutexWait(addr, performance.now() - tStart);
 #endif
       return 0;
     }
   },
 
+#if MAIN_THREAD_ASYNC_WAITS
+  _emscripten_main_thread_waits_async__deps: ['$Asyncify'],
+#endif
+  _emscripten_main_thread_waits_async: function() {
+#if MAIN_THREAD_ASYNC_WAITS
+    // Matches the check in emscripten_futex_wait.
+    return ENVIRONMENT_IS_WEB && typeof Atomics.waitAsync === 'function' &&
+           Asyncify.exportCallStack.length === 1 && Asyncify.exportCanSleep;
+#else
+    return 0;
+#endif
+  },
+
   // Returns the number of threads (>= 0) woken up, or the value -EINVAL on error.
   // Pass count == INT_MAX to wake up all threads.
   emscripten_futex_wake: function(addr, count) {
@@ -62,6 +62,11 @@ mergeInto(LibraryManager.library, {
         peers: {},
         pending: [],
         recv_queue: [],
+        // stream sockets accumulate incoming bytes in recv_buffer, with the
+        // unread data living in [recv_start, recv_end)
+        recv_buffer: null,
+        recv_start: 0,
+        recv_end: 0,
 #if SOCKET_WEBRTC
 #else
         sock_ops: SOCKFS.websocket_sock_ops
@@ -242,7 +247,12 @@ mergeInto(LibraryManager.library, {
           addr: addr,
           port: port,
           socket: ws,
-          dgram_send_queue: []
+          dgram_send_queue: [],
+#if SOCKET_COALESCE_SENDS
+          send_buffer: null,
+          send_length: 0,
+          send_scheduled: false,
+#endif
         };
 
         SOCKFS.websocket_sock_ops.addPeer(sock, peer);
@@ -273,6 +283,84 @@ mergeInto(LibraryManager.library, {
       removePeer: function(sock, peer) {
         delete sock.peers[peer.addr + ':' + peer.port];
       },
+      //
+      // stream sockets don't preserve message boundaries, so rather than
+      // queueing an object per WebSocket message, incoming data is appended
+      // to a single contiguous buffer which recvmsg reads straight out of
+      //
+      appendStreamData: function(sock, data) {
+        var length = data.length;
+        var buffer = sock.recv_buffer;
+        if (!buffer || sock.recv_end + length > buffer.length) {
+          var used = sock.recv_end - sock.recv_start;
+          if (buffer && used + length <= buffer.length) {
+            // there is enough room once the data already read is discarded
+            buffer.copyWithin(0, sock.recv_start, sock.recv_end);
+          } else {
+            var capacity = buffer ? buffer.length : 4096;
+            while (capacity < used + length) capacity *= 2;
+            var newBuffer = new Uint8Array(capacity);
+            if (buffer) {
+              newBuffer.set(buffer.subarray(sock.recv_start, sock.recv_end));
+            }
+            sock.recv_buffer = buffer = newBuffer;
+          }
+          sock.recv_start = 0;
+          sock.recv_end = used;
+        }
+        buffer.set(data, sock.recv_end);
+        sock.recv_end += length;
+      },
+#if SOCKET_COALESCE_SENDS
+      //
+      // outgoing data on stream sockets is batched per peer and sent as a
+      // single WebSocket message once the current event loop task finishes
+      // (or as soon as enough data has accumulated)
+      //
+      queueStreamSend: function(peer, data) {
+        var length = data.length;
+        var buffer = peer.send_buffer;
+        if (!buffer || peer.send_length + length > buffer.length) {
+          var capacity = buffer ? buffer.length : 4096;
+          while (capacity < peer.send_length + length) capacity *= 2;
+          var newBuffer = new Uint8Array(capacity);
+          if (buffer) {
+            newBuffer.set(buffer.subarray(0, peer.send_length));
+          }
+          peer.send_buffer = buffer = newBuffer;
+        }
+        buffer.set(data, peer.send_length);
+        peer.send_length += length;
+
+        // don't let a single batch grow without bound
+        if (peer.send_length >= 65536) {
+          SOCKFS.websocket_sock_ops.flushStreamSends(peer);
+        } else if (!peer.send_scheduled) {
+          peer.send_scheduled = true;
+          Promise.resolve().then(function() {
+            SOCKFS.websocket_sock_ops.flushStreamSends(peer);
+          });
+        }
+      },
+      flushStreamSends: function(peer) {
+        peer.send_scheduled = false;
+        if (!peer.send_length) {
+          return;
+        }
+        var data = peer.send_buffer.slice(0, peer.send_length).buffer;
+        peer.send_length = 0;
+        try {
+#if SOCKET_DEBUG
+          out('websocket send coalesced (' + data.byteLength + ' bytes): ' + [Array.prototype.slice.call(new Uint8Array(data))]);
+#endif
+          peer.socket.send(data);
+        } catch (e) {
+          // as with queued dgram data, we've already reported this data as
+          // sent, so the best we can do is shut the connection down.
+          peer.socket.close();
+        }
+      },
+#endif
       handlePeerEvents: function(sock, peer) {
         var first = true;
 
@@ -334,7 +422,11 @@ mergeInto(LibraryManager.library, {
             return;
           }
 
-          sock.recv_queue.push({ addr: peer.addr, port: peer.port, data: data });
+          if (sock.type === {{{ cDefine('SOCK_STREAM') }}}) {
+            SOCKFS.websocket_sock_ops.appendStreamData(sock, data);
+          } else {
+            sock.recv_queue.push({ addr: peer.addr, port: peer.port, data: data });
+          }
           Module['websocket'].emit('message', sock.stream.fd);
         };
 
@@ -391,6 +483,7 @@ mergeInto(LibraryManager.library, {
           null;
 
         if (sock.recv_queue.length ||
+            sock.recv_end > sock.recv_start ||
             !dest ||  // connection-less sockets are always ready to read
             (dest && dest.socket.readyState === dest.socket.CLOSING) ||
             (dest && dest.socket.readyState === dest.socket.CLOSED)) {  // let recv return 0 once closed
@@ -413,7 +506,9 @@ mergeInto(LibraryManager.library, {
         switch (request) {
           case {{{ cDefine('FIONREAD') }}}:
             var bytes = 0;
-            if (sock.recv_queue.length) {
+            if (sock.type === {{{ cDefine('SOCK_STREAM') }}}) {
+              bytes = sock.recv_end - sock.recv_start;
+            } else if (sock.recv_queue.length) {
               bytes = sock.recv_queue[0].data.length;
             }
             {{{ makeSetValue('arg', '0', 'bytes', 'i32') }}};
@@ -436,6 +531,9 @@ mergeInto(LibraryManager.library, {
         for (var i = 0; i < peers.length; i++) {
           var peer = sock.peers[peers[i]];
           try {
+#if SOCKET_COALESCE_SENDS
+            SOCKFS.websocket_sock_ops.flushStreamSends(peer);
+#endif
             peer.socket.close();
           } catch (e) {
           }
@@ -612,6 +710,21 @@ mergeInto(LibraryManager.library, {
           }
         }
 
+#if SOCKET_COALESCE_SENDS
+        if (sock.type === {{{ cDefine('SOCK_STREAM') }}}) {
+          if (ArrayBuffer.isView(buffer)) {
+            buffer = new Uint8Array(buffer.buffer, buffer.byteOffset + offset, length);
+          } else {
+            buffer = new Uint8Array(buffer, offset, length);
+          }
+#if SOCKET_DEBUG
+          out('websocket queuing stream data (' + length + ' bytes): ' + [Array.prototype.slice.call(buffer)]);
+#endif
+          SOCKFS.websocket_sock_ops.queueStreamSend(dest, buffer);
+          return length;
+        }
+#endif
+
         // create a copy of the incoming data to send, as the WebSocket API
         // doesn't work entirely with an ArrayBufferView, it'll just send
         // the entire underlying buffer
@@ -668,9 +781,11 @@ mergeInto(LibraryManager.library, {
           throw new FS.ErrnoError({{{ cDefine('ENOTCONN') }}});
         }
 
-        var queued = sock.recv_queue.shift();
-        if (!queued) {
-          if (sock.type === {{{ cDefine('SOCK_STREAM') }}}) {
+        var bytesRead;
+        var res;
+        if (sock.type === {{{ cDefine('SOCK_STREAM') }}}) {
+          var available = sock.recv_end - sock.recv_start;
+          if (!available) {
             var dest = SOCKFS.websocket_sock_ops.getPeer(sock, sock.daddr, sock.dport);
 
             if (!dest) {
@@ -685,19 +800,39 @@ mergeInto(LibraryManager.library, {
               // else, our socket is in a valid state but truly has nothing available
               throw new FS.ErrnoError({{{ cDefine('EAGAIN') }}});
             }
-          } else {
-            throw new FS.ErrnoError({{{ cDefine('EAGAIN') }}});
           }
+
+          // the returned buffer is a view into recv_buffer, which is only
+          // valid until more data arrives, so callers must copy out of it
+          // before returning to the event loop
+          bytesRead = Math.min(length, available);
+          res = {
+            buffer: sock.recv_buffer.subarray(sock.recv_start, sock.recv_start + bytesRead),
+            addr: sock.daddr,
+            port: sock.dport
+          };
+
+#if SOCKET_DEBUG
+          out('websocket read (' + bytesRead + ' bytes): ' + [Array.prototype.slice.call(res.buffer)]);
+#endif
+
+          sock.recv_start += bytesRead;
+          if (sock.recv_start === sock.recv_end) {
+            sock.recv_start = sock.recv_end = 0;
+          }
+          return res;
+        }
+
+        var queued = sock.recv_queue.shift();
+        if (!queued) {
+          throw new FS.ErrnoError({{{ cDefine('EAGAIN') }}});
         }
 
-        // queued.data will be an ArrayBuffer if it's unadulterated, but if it's
-        // requeued TCP data it'll be an ArrayBufferView
-        var queuedLength = queued.data.byteLength || queued.data.length;
-        var queuedOffset = queued.data.byteOffset || 0;
-        var queuedBuffer = queued.data.buffer || queued.data;
-        var bytesRead = Math.min(length, queuedLength);
-        var res = {
-          buffer: new Uint8Array(queuedBuffer, queuedOffset, bytesRead),
+        // datagrams are delivered whole (or truncated), never split across
+        // reads
+        bytesRead = Math.min(length, queued.data.length);
+        res = {
+          buffer: queued.data.subarray(0, bytesRead),
           addr: queued.addr,
           port: queued.port
         };
@@ -706,16 +841,6 @@ mergeInto(LibraryManager.library, {
         out('websocket read (' + bytesRead + ' bytes): ' + [Array.prototype.slice.call(res.buffer)]);
 #endif
 
-        // push back any unread data for TCP connections
-        if (sock.type === {{{ cDefine('SOCK_STREAM') }}} && bytesRead < queuedLength) {
-          var bytesRemaining = queuedLength - bytesRead;
-#if SOCKET_DEBUG
-          out('websocket read: put back ' + bytesRemaining + ' bytes');
-#endif
-          queued.data = new Uint8Array(queuedBuffer, queuedOffset + bytesRead, bytesRemaining);
-          sock.recv_queue.unshift(queued);
-        }
-
         return res;
       }
     }
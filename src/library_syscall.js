@@ -176,6 +176,32 @@ var SyscallsLibrary = {
         buffer.push(curr);
       }
     },
+    // Equivalent to calling printChar on each byte, but decodes complete lines
+    // in one go.
+    printChars: function(stream, ptr, len) {
+      var buffer = SYSCALLS.buffers[stream];
+#if ASSERTIONS
+      assert(buffer);
+#endif
+      var chunk = HEAPU8.subarray(ptr, ptr + len);
+      while (chunk.length) {
+        var newline = chunk.indexOf({{{ charCode('\n') }}});
+        var zero = chunk.indexOf(0);
+        var end = newline < 0 ? zero : zero < 0 ? newline : Math.min(newline, zero);
+        if (end < 0) {
+          for (var i = 0; i < chunk.length; i++) buffer.push(chunk[i]);
+          break;
+        }
+        if (buffer.length) {
+          for (var i = 0; i < end; i++) buffer.push(chunk[i]);
+          (stream === 1 ? out : err)(UTF8ArrayToString(buffer, 0));
+          buffer.length = 0;
+        } else {
+          (stream === 1 ? out : err)(UTF8ArrayToString(chunk, 0, end));
+        }
+        chunk = chunk.subarray(end + 1);
+      }
+    },
 #endif // SYSCALLS_REQUIRE_FILESYSTEM
 
     // arguments handling
@@ -246,9 +272,9 @@ var SyscallsLibrary = {
       allocated = true;
     } else {
 #if FILESYSTEM && SYSCALLS_REQUIRE_FILESYSTEM
-      var info = FS.getStream(fd);
-      if (!info) return -{{{ cDefine('EBADF') }}};
-      var res = FS.mmap(info, addr, len, off, prot, flags);
+      var stream = FS.getStream(fd);
+      if (!stream) return -{{{ cDefine('EBADF') }}};
+      var res = FS.mmap(stream, addr, len, off, prot, flags);
       ptr = res.ptr;
       allocated = res.allocated;
 #else // no filesystem support; report lack of support
@@ -258,7 +284,19 @@ var SyscallsLibrary = {
 #if CAN_ADDRESS_2GB
     ptr >>>= 0;
 #endif
-    SYSCALLS.mappings[ptr] = { malloc: ptr, len: len, allocated: allocated, fd: fd, prot: prot, flags: flags, offset: off };
+    var info = { malloc: ptr, len: len, allocated: allocated, fd: fd, prot: prot, flags: flags, offset: off,
+#if FILESYSTEM && SYSCALLS_REQUIRE_FILESYSTEM
+      stream: stream,
+#endif
+    };
+    // Shared mappings of the same part of a file get the same address, so
+    // each address has a list of the mappings made there.
+    var list = SYSCALLS.mappings[ptr];
+    if (list) {
+      list.push(info);
+    } else {
+      SYSCALLS.mappings[ptr] = [info];
+    }
     return ptr;
   },
 
@@ -272,26 +310,40 @@ var SyscallsLibrary = {
     addr >>>= 0;
 #endif
     // TODO: support unmmap'ing parts of allocations
-    var info = SYSCALLS.mappings[addr];
-    if (len === 0 || !info) {
+    var list = SYSCALLS.mappings[addr];
+    if (len === 0 || !list) {
       return -{{{ cDefine('EINVAL') }}};
     }
-    if (len === info.len) {
+    var info;
+    for (var i = 0; i < list.length; i++) {
+      if (list[i].len === len) {
+        info = list[i];
+        list.splice(i, 1);
+        break;
+      }
+    }
+    if (info) {
 #if FILESYSTEM && SYSCALLS_REQUIRE_FILESYSTEM
       var stream = FS.getStream(info.fd);
-      if (stream) {
-        if (info.prot & {{{ cDefine('PROT_WRITE') }}}) {
-          SYSCALLS.doMsync(addr, stream, len, info.flags, info.offset);
-        }
-        FS.munmap(stream);
+      // A mapping that wasn't allocated points directly at the file's data,
+      // so there is nothing to write back.
+      if (stream && info.allocated && (info.prot & {{{ cDefine('PROT_WRITE') }}})) {
+        SYSCALLS.doMsync(addr, stream, len, info.flags, info.offset);
+      }
+      // The mapping outlives the file descriptor it was made with, so release
+      // it through the stream it was made from, even if that is now closed.
+      if (info.stream) {
+        FS.munmap(info.stream, info.flags);
       }
 #else
 #if ASSERTIONS
       // Without FS support, only anonymous mappings are supported.
-      assert(SYSCALLS.mappings[addr].flags & {{{ cDefine('MAP_ANONYMOUS') }}});
+      assert(info.flags & {{{ cDefine('MAP_ANONYMOUS') }}});
 #endif
 #endif
-      SYSCALLS.mappings[addr] = null;
+      if (!list.length) {
+        delete SYSCALLS.mappings[addr];
+      }
       if (info.allocated) {
         _free(info.malloc);
       }
@@ -746,8 +798,10 @@ var SyscallsLibrary = {
 #if CAN_ADDRESS_2GB
     addr >>>= 0;
 #endif
-    var info = SYSCALLS.mappings[addr];
-    if (!info) return 0;
+    // Allocated mappings are never at the same address as another mapping.
+    var list = SYSCALLS.mappings[addr];
+    var info = list && list[0];
+    if (!info || !info.allocated) return 0;
     SYSCALLS.doMsync(addr, FS.getStream(info.fd), len, info.flags, 0);
     return 0;
   },
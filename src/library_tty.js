@@ -14,7 +14,95 @@ mergeInto(LibraryManager.library, {
 #endif
   $TTY: {
     ttys: [],
+#if ENVIRONMENT_MAY_BE_NODE
+    // When running in node with stdout redirected to a file or a pipe, complete
+    // lines written to stdout are staged here and written out in large chunks,
+    // rather than decoded and printed one line at a time.
+    nodeStdout: null,
+    nodeStdoutLength: 0,
+    nodeStdoutFlushQueued: false,
+    stageNodeStdout: function(bytes) {
+      // Zeros are dropped, as when printing a line with out().
+      var hasZero = bytes.indexOf(0) >= 0;
+      for (var i = 0; i < bytes.length;) {
+        if (TTY.nodeStdoutLength === TTY.nodeStdout.length) {
+          TTY.flushNodeStdout();
+        }
+        if (hasZero) {
+          if (bytes[i]) TTY.nodeStdout[TTY.nodeStdoutLength++] = bytes[i];
+          i++;
+          continue;
+        }
+        var count = Math.min(bytes.length - i, TTY.nodeStdout.length - TTY.nodeStdoutLength);
+        TTY.nodeStdout.set(bytes.subarray ? bytes.subarray(i, i + count) : bytes.slice(i, i + count), TTY.nodeStdoutLength);
+        TTY.nodeStdoutLength += count;
+        i += count;
+      }
+      // Write out whatever is staged once we return to the event loop, so that
+      // output from a long running program is not held back indefinitely.
+      if (!TTY.nodeStdoutFlushQueued) {
+        TTY.nodeStdoutFlushQueued = true;
+        setImmediate(TTY.flushNodeStdout);
+      }
+    },
+    flushNodeStdout: function() {
+      TTY.nodeStdoutFlushQueued = false;
+      var written = 0;
+      while (written < TTY.nodeStdoutLength) {
+        written += nodeFS.writeSync(1, TTY.nodeStdout, written, TTY.nodeStdoutLength - written);
+      }
+      TTY.nodeStdoutLength = 0;
+    },
+#endif
+    // Appends bytes to a tty's pending line, dropping any zeros, which would
+    // otherwise cut the text off when it is printed.
+    appendOutput: function(tty, bytes) {
+      for (var i = 0; i < bytes.length; i++) {
+        if (bytes[i]) tty.output.push(bytes[i]);
+      }
+    },
+    // Prints each complete line in buffer, decoding it in one go, and keeps any
+    // trailing partial line in tty.output.
+    writeLines: function(tty, buffer, offset, length, print) {
+      var chunk = buffer.subarray(offset, offset + length);
+      while (chunk.length) {
+        var newline = chunk.indexOf({{{ charCode('\n') }}});
+        if (newline < 0) {
+          TTY.appendOutput(tty, chunk);
+          break;
+        }
+        var line = chunk.subarray(0, newline);
+        if (tty.output.length || line.indexOf(0) >= 0) {
+          TTY.appendOutput(tty, line);
+          print(UTF8ArrayToString(tty.output, 0));
+          tty.output = [];
+        } else {
+          print(UTF8ArrayToString(line, 0, line.length));
+        }
+        chunk = chunk.subarray(newline + 1);
+      }
+    },
     init: function () {
+#if ENVIRONMENT_MAY_BE_NODE
+      if (ENVIRONMENT_IS_NODE && !Module['print'] && !require('tty').isatty(1)) {
+        // nodeFS is otherwise only set up when reading files, which builds
+        // that embed the wasm (SINGLE_FILE, WASM=0) never do.
+        if (!nodeFS) nodeFS = require('fs');
+        TTY.nodeStdout = new Uint8Array(64 * 1024);
+        // Lines printed directly with out() are staged as well, so that all of
+        // stdout is written through the same fd in order. Anything printed
+        // with err() must come after the stdout bytes staged before it.
+        var printErr = err;
+        out = function(text) {
+          TTY.stageNodeStdout(intArrayFromString(text + '\n', true));
+        };
+        err = function(text) {
+          TTY.flushNodeStdout();
+          printErr(text);
+        };
+        process['on']('exit', TTY.flushNodeStdout);
+      }
+#endif
       // https://github.com/emscripten-core/emscripten/pull/1555
       // if (ENVIRONMENT_IS_NODE) {
       //   // currently, FS.init does not distinguish if process.stdin is a file or TTY
@@ -25,6 +113,11 @@ mergeInto(LibraryManager.library, {
       // }
     },
     shutdown: function() {
+#if ENVIRONMENT_MAY_BE_NODE
+      if (TTY.nodeStdout) {
+        TTY.flushNodeStdout();
+      }
+#endif
       // https://github.com/emscripten-core/emscripten/pull/1555
       // if (ENVIRONMENT_IS_NODE) {
       //   // inolen: any idea as to why node -e 'process.stdin.read()' wouldn't exit immediately (with process.stdin being a tty)?
@@ -80,12 +173,16 @@ mergeInto(LibraryManager.library, {
         return bytesRead;
       },
       write: function(stream, buffer, offset, length, pos) {
-        if (!stream.tty || !stream.tty.ops.put_char) {
+        if (!stream.tty || (!stream.tty.ops.put_char && !stream.tty.ops.put_chars)) {
           throw new FS.ErrnoError({{{ cDefine('ENXIO') }}});
         }
         try {
-          for (var i = 0; i < length; i++) {
-            stream.tty.ops.put_char(stream.tty, buffer[offset+i]);
+          if (stream.tty.ops.put_chars && ArrayBuffer.isView(buffer)) {
+            stream.tty.ops.put_chars(stream.tty, buffer, offset, length);
+          } else {
+            for (var i = 0; i < length; i++) {
+              stream.tty.ops.put_char(stream.tty, buffer[offset+i]);
+            }
           }
         } catch (e) {
           throw new FS.ErrnoError({{{ cDefine('EIO') }}});
@@ -93,7 +190,7 @@ mergeInto(LibraryManager.library, {
         if (length) {
           stream.node.timestamp = Date.now();
         }
-        return i;
+        return length;
       }
     },
     default_tty_ops: {
@@ -156,6 +253,26 @@ mergeInto(LibraryManager.library, {
           if (val != 0) tty.output.push(val); // val == 0 would cut text output off in the middle.
         }
       },
+      put_chars: function(tty, buffer, offset, length) {
+#if ENVIRONMENT_MAY_BE_NODE
+        if (TTY.nodeStdout) {
+          // Stage everything up to the last newline, and keep the rest as the
+          // pending line, as put_char would.
+          var chunk = buffer.subarray(offset, offset + length);
+          var newline = chunk.lastIndexOf({{{ charCode('\n') }}});
+          if (newline >= 0) {
+            if (tty.output.length) {
+              TTY.stageNodeStdout(tty.output);
+              tty.output = [];
+            }
+            TTY.stageNodeStdout(chunk.subarray(0, newline + 1));
+          }
+          TTY.appendOutput(tty, chunk.subarray(newline + 1));
+          return;
+        }
+#endif
+        TTY.writeLines(tty, buffer, offset, length, out);
+      },
       flush: function(tty) {
         if (tty.output && tty.output.length > 0) {
           out(UTF8ArrayToString(tty.output, 0));
@@ -172,6 +289,9 @@ mergeInto(LibraryManager.library, {
           if (val != 0) tty.output.push(val);
         }
       },
+      put_chars: function(tty, buffer, offset, length) {
+        TTY.writeLines(tty, buffer, offset, length, err);
+      },
       flush: function(tty) {
         if (tty.output && tty.output.length > 0) {
           err(UTF8ArrayToString(tty.output, 0));
@@ -206,9 +206,7 @@ var WasiLibrary = {
       var ptr = {{{ makeGetValue('iov', C_STRUCTS.iovec.iov_base, 'i32') }}};
       var len = {{{ makeGetValue('iov', C_STRUCTS.iovec.iov_len, 'i32') }}};
       iov += {{{ C_STRUCTS.iovec.__size__ }}};
-      for (var j = 0; j < len; j++) {
-        SYSCALLS.printChar(fd, HEAPU8[ptr+j]);
-      }
+      SYSCALLS.printChars(fd, ptr, len);
       num += len;
     }
 #endif // SYSCALLS_REQUIRE_FILESYSTEM
@@ -39,6 +39,165 @@ function genArgSequence(n) {
   return args;
 }
 
+// Keeps the preprocessed and macro-expanded source of library files in
+// JS_LIBRARY_CACHE_DIR, so that later runs of the compiler can skip processing
+// them again.
+//
+// What processing a file produces depends on the file itself, on the files it
+// #includes, and on whichever compiler globals (mostly settings, but also the
+// helper functions used in macros) it reads along the way.  While a file is
+// processed those globals are turned into accessors that record each read, and
+// the cache entry stores a description of the value of every global that was
+// read.  An entry is only used if all of them still have the same value.
+// Files whose processing prints anything, or has side effects on the globals
+// (e.g. library_webgl.js, which defines helpers for other files to use in
+// their macros), are not cached, as those effects would be lost.
+var LibraryCache = {
+  // The number of entries kept for each file, e.g. for different settings.
+  maxEntries: 4,
+  tracked: new Set(),
+  // The globals read while processing the current file, with the description
+  // of their value at the time, and the files read by it.
+  reads: null,
+  files: null,
+  uncacheable: false,
+  baseKey: null,
+
+  hash: function(data) {
+    return nodeCrypto.createHash('sha256').update(data).digest('hex');
+  },
+
+  describe: function(name, value) {
+    // Macros only ask LibraryManager which libraries are in use.
+    if (name == 'LibraryManager') value = value.libraries;
+    if (typeof value == 'function') return value.toString();
+    return String(JSON.stringify(value));
+  },
+
+  // Processing also depends on the state that the compiler code sets up
+  // outside of globals when it is loaded, e.g. POINTER_SIZE in parseTools.js.
+  getBaseKey: function() {
+    if (!this.baseKey) {
+      var sources = ['utility.js', 'modules.js', 'parseTools.js'].map(read);
+      this.baseKey = this.hash(JSON.stringify([EMSCRIPTEN_VERSION, MEMORY64, sources]));
+    }
+    return this.baseKey;
+  },
+
+  // Turns every compiler global that is not tracked yet into an accessor.
+  track: function() {
+    var cache = this;
+    Object.getOwnPropertyNames(global).forEach((name) => {
+      if (builtinGlobals.has(name) || this.tracked.has(name)) return;
+      var desc = Object.getOwnPropertyDescriptor(global, name);
+      if (!desc.configurable || !('value' in desc)) return;
+      var value = desc.value;
+      this.tracked.add(name);
+      Object.defineProperty(global, name, {
+        configurable: true,
+        enumerable: desc.enumerable,
+        get: function() {
+          if (!cache.reads) return value;
+          if (name == 'print' || name == 'printErr') {
+            cache.uncacheable = true;
+          } else if (name == 'read') {
+            return (filename) => {
+              var text = value(filename);
+              cache.files[filename] = cache.hash(text);
+              return text;
+            };
+          } else if (!cache.reads.has(name)) {
+            try {
+              cache.reads.set(name, cache.describe(name, value));
+            } catch (e) {
+              cache.uncacheable = true;
+            }
+          }
+          return value;
+        },
+        set: function(newValue) {
+          if (cache.reads) cache.uncacheable = true;
+          value = newValue;
+        },
+      });
+    });
+  },
+
+  untrack: function() {
+    for (var name of this.tracked) {
+      var desc = Object.getOwnPropertyDescriptor(global, name);
+      Object.defineProperty(global, name, {
+        configurable: true,
+        enumerable: desc.enumerable,
+        writable: true,
+        value: global[name],
+      });
+    }
+    this.tracked.clear();
+  },
+
+  isValid: function(entry) {
+    try {
+      for (var name in entry.globals) {
+        if (!(name in global) || this.describe(name, global[name]) !== entry.globals[name]) return false;
+      }
+      for (var filename in entry.files) {
+        if (this.hash(read(filename)) !== entry.files[filename]) return false;
+      }
+    } catch (e) {
+      return false;
+    }
+    return true;
+  },
+
+  // Returns the processed source of a library file, from the cache if possible.
+  process: function(filename, src) {
+    var cacheFile = nodePath.join(JS_LIBRARY_CACHE_DIR, this.hash(JSON.stringify([this.getBaseKey(), filename, src])) + '.json');
+    var entries = [];
+    try {
+      entries = JSON.parse(nodeFS.readFileSync(cacheFile, 'utf8'));
+    } catch (e) {
+      // No entries for this file yet.
+    }
+    for (var entry of entries) {
+      if (this.isValid(entry)) {
+        if (VERBOSE) printErr(`using cached preprocessed source for ${filename}`);
+        return entry.text;
+      }
+    }
+
+    this.track();
+    var numGlobals = Object.getOwnPropertyNames(global).length;
+    var reads = this.reads = new Map();
+    var files = this.files = {};
+    this.uncacheable = false;
+    try {
+      var text = processMacros(preprocess(src, filename));
+    } finally {
+      this.reads = null;
+    }
+    if (this.uncacheable || Object.getOwnPropertyNames(global).length != numGlobals) {
+      return text;
+    }
+    entry = {globals: {}, files: files, text: text};
+    try {
+      for (var [name, description] of reads) {
+        // Objects that were modified in place are a side effect too.
+        if (this.describe(name, global[name]) !== description) return text;
+        entry.globals[name] = description;
+      }
+      entries = [entry].concat(entries).slice(0, this.maxEntries);
+      var tempFile = `${cacheFile}.${process.pid}.tmp`;
+      nodeFS.mkdirSync(JS_LIBRARY_CACHE_DIR, {recursive: true});
+      nodeFS.writeFileSync(tempFile, JSON.stringify(entries));
+      nodeFS.renameSync(tempFile, cacheFile);
+    } catch (e) {
+      // The cache is only an optimization, so carry on without it.
+    }
+    return text;
+  },
+};
+
 // List of functions that were added from the library.
 var libraryFunctions = [];
 
@@ -211,7 +370,11 @@ var LibraryManager = {
         });
       }
       try {
-        processed = processMacros(preprocess(src, filename));
+        if (JS_LIBRARY_CACHE_DIR) {
+          processed = LibraryCache.process(filename, src);
+        } else {
+          processed = processMacros(preprocess(src, filename));
+        }
         eval(processed);
       } catch(e) {
         var details = [e, e.lineNumber ? `line number: ${e.lineNumber}` : ''];
@@ -240,6 +403,7 @@ var LibraryManager = {
         }
       }
     }
+    LibraryCache.untrack();
 
     // apply synonyms. these are typically not speed-sensitive, and doing it
     // this way makes it possible to not include hacks in the compiler
@@ -176,6 +176,9 @@ function callMain(args) {
     // that if we get here main returned zero.
     var ret = 0;
 #else
+#if MAIN_THREAD_ASYNC_WAITS
+    Asyncify.nextExportCanSleep = true;
+#endif
     var ret = entryFunction(argc, argv);
 #endif // STANDALONE_WASM
 
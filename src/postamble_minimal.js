@@ -238,6 +238,11 @@ WebAssembly.instantiate(Module['wasm'], imports).then(function(output) {
   ready();
 #endif
 
+#if USE_PTHREADS && PTHREAD_POOL_LOW_WATER
+  // Spawn the rest of the low-water mark of Workers in the background.
+  if (!ENVIRONMENT_IS_PTHREAD) PThread.queuePoolRefill();
+#endif
+
 #if USE_PTHREADS
   // This Worker is now ready to host pthreads, tell the main thread we can proceed.
   if (ENVIRONMENT_IS_PTHREAD) {
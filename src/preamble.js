@@ -128,6 +128,9 @@ function ccall(ident, returnType, argTypes, args, opts) {
       }
     }
   }
+#if MAIN_THREAD_ASYNC_WAITS
+  if (opts && opts.async) Asyncify.nextExportCanSleep = true;
+#endif
   var ret = func.apply(null, cArgs);
   function onDone(ret) {
 #if ASYNCIFY
@@ -813,6 +816,61 @@ if (Module['locateFile']) {
 }
 #endif
 
+#if NODE_CODE_CACHING || WASM_MODULE_CACHE
+// A hash of the contents of the wasm binary, filled in by emcc at link time.
+// Compiled code is cached under this rather than under the file name, so that
+// a cache entry can never outlive the binary it was compiled from.
+var wasmBinaryHash = '<<< WASM_BINARY_HASH >>>';
+#endif
+
+#if WASM_MODULE_CACHE
+// Fetches the wasm binary through the Cache Storage API, keyed by the content
+// hash of the binary.  Streaming compilation from a cached response lets the
+// browser reuse the code it compiled on a previous load.
+function fetchWasmResponse() {
+  function fetchFromNetwork() {
+    return fetch(wasmBinaryFile, { credentials: 'same-origin' });
+  }
+  if (typeof caches === 'undefined') {
+    // Cache Storage is only available in secure contexts.
+    return fetchFromNetwork();
+  }
+  var cacheKey = new URL(wasmBinaryFile + '.' + wasmBinaryHash, location.href).toString();
+  return caches.open('emscripten-wasm:' + wasmBinaryFile).then(function(cache) {
+    return cache.match(cacheKey).then(function(cached) {
+      Module['wasmFromCache'] = !!cached;
+      if (cached) {
+#if RUNTIME_LOGGING
+        err('WASM_MODULE_CACHE: loading ' + cacheKey);
+#endif
+        return cached;
+      }
+      return fetchFromNetwork().then(function(response) {
+        if (response['ok']) {
+#if RUNTIME_LOGGING
+          err('WASM_MODULE_CACHE: saving ' + cacheKey);
+#endif
+          // Only once the new entry is in place are the entries for previous
+          // builds removed, so there is never a moment without a usable entry.
+          cache.put(cacheKey, response.clone()).then(function() {
+            return cache.keys();
+          }).then(function(keys) {
+            return Promise.all(keys.filter(function(key) {
+              return key.url !== cacheKey;
+            }).map(function(key) {
+              return cache.delete(key);
+            }));
+          }).catch(function(e) {
+            err('WASM_MODULE_CACHE: failed to update cache: ' + e);
+          });
+        }
+        return response;
+      });
+    });
+  }, fetchFromNetwork);
+}
+#endif
+
 function getBinary(file) {
   try {
     if (file == wasmBinaryFile && wasmBinary) {
@@ -922,10 +980,13 @@ function instantiateSync(file, info) {
       var v8 = require('v8');
       // Include the V8 version in the cache name, so that we don't try to
       // load cached code from another version, which fails silently (it seems
-      // to load ok, but we do actually recompile the binary every time).
-      var cachedCodeFile = '{{{ WASM_BINARY_FILE }}}.' + v8.cachedDataVersionTag() + '.cached';
+      // to load ok, but we do actually recompile the binary every time).  The
+      // hash of the binary is included so that a rebuilt binary with the same
+      // name doesn't pick up stale code.
+      var cachedCodeFile = '{{{ WASM_BINARY_FILE }}}.' + wasmBinaryHash + '.' + v8.cachedDataVersionTag() + '.cached';
       cachedCodeFile = locateFile(cachedCodeFile);
       if (!nodeFS) nodeFS = require('fs');
+      if (!nodePath) nodePath = require('path');
       var hasCached = nodeFS.existsSync(cachedCodeFile);
       if (hasCached) {
 #if RUNTIME_LOGGING
@@ -947,7 +1008,22 @@ function instantiateSync(file, info) {
 #if RUNTIME_LOGGING
       err('NODE_CODE_CACHING: saving module');
 #endif
-      nodeFS.writeFileSync(cachedCodeFile, v8.serialize(module));
+      // Write to a temporary file and rename it into place, so that another
+      // process starting up concurrently never sees a partially written file.
+      var tempFile = cachedCodeFile + '.' + process.pid + '.tmp';
+      nodeFS.writeFileSync(tempFile, v8.serialize(module));
+      nodeFS.renameSync(tempFile, cachedCodeFile);
+      // Remove any code cached for previous builds of the binary.
+      var cacheDir = nodePath.dirname(cachedCodeFile);
+      var cachePrefix = nodePath.basename(locateFile('{{{ WASM_BINARY_FILE }}}')) + '.';
+      nodeFS.readdirSync(cacheDir).forEach(function(name) {
+        if (name.startsWith(cachePrefix) && name.endsWith('.cached') &&
+            name !== nodePath.basename(cachedCodeFile)) {
+          try {
+            nodeFS.unlinkSync(nodePath.join(cacheDir, name));
+          } catch (e) {}
+        }
+      });
     }
 #else // NODE_CODE_CACHING
     module = new WebAssembly.Module(binary);
@@ -987,9 +1063,35 @@ function resetPrototype(constructor, attrs) {
 }
 #endif
 
+#if HEAP_SNAPSHOT
+// Set while emcc runs the program at link time to take a heap snapshot.
+var takingHeapSnapshot = ENVIRONMENT_IS_NODE && !!process.env['EMCC_HEAP_SNAPSHOT_FILE'];
+// The imports that global constructors called while the snapshot was taken.
+// Programs started from the snapshot don't run the constructors, so anything
+// these did outside of wasm memory would be missing.
+var heapSnapshotCtorImports = [];
+// Imports that only read or change wasm memory, which are fine to call.
+var heapSnapshotMemoryImports = ['emscripten_memcpy_big', 'emscripten_resize_heap', 'emscripten_get_heap_max', 'setTempRet0', 'getTempRet0'];
+#endif
+
 // Create the wasm instance.
 // Receives the wasm imports, returns the exports.
 function createWasm() {
+#if HEAP_SNAPSHOT
+  var runningCtors = false;
+  if (takingHeapSnapshot) {
+    Object.keys(asmLibraryArg).forEach(function(name) {
+      var func = asmLibraryArg[name];
+      if (typeof func != 'function' || heapSnapshotMemoryImports.includes(name)) return;
+      asmLibraryArg[name] = function() {
+        if (runningCtors && !heapSnapshotCtorImports.includes(name)) {
+          heapSnapshotCtorImports.push(name);
+        }
+        return func.apply(null, arguments);
+      };
+    });
+  }
+#endif
   // prepare imports
   var info = {
 #if MINIFY_WASM_IMPORTED_MODULES
@@ -1072,8 +1174,22 @@ function createWasm() {
 #endif
 
 #if hasExportedFunction('___wasm_call_ctors')
+#if HEAP_SNAPSHOT
+    if (takingHeapSnapshot) {
+      addOnInit(function() {
+        runningCtors = true;
+        Module['asm']['__wasm_call_ctors']();
+        runningCtors = false;
+      });
+    } else if (!Module['asm']['emscripten_snapshot_restored']()) {
+      // When starting from a heap snapshot the constructors have already run,
+      // and their effects are part of the initial contents of memory.
+      addOnInit(Module['asm']['__wasm_call_ctors']);
+    }
+#else
     addOnInit(Module['asm']['__wasm_call_ctors']);
 #endif
+#endif
 
 #if ABORT_ON_WASM_EXCEPTIONS
     instrumentWasmTableWithAbort();
@@ -1103,6 +1219,10 @@ function createWasm() {
       // PTHREAD_POOL_DELAY_LOAD==1 (or no preloaded pool in use): do not wait up for the Workers to
       // instantiate the Wasm module, but proceed with main() immediately.
       removeRunDependency('wasm-instantiate');
+#endif
+#if PTHREAD_POOL_LOW_WATER
+      // Spawn the rest of the low-water mark of Workers in the background.
+      PThread.queuePoolRefill();
 #endif
     }
 #else // singlethreaded build:
@@ -1201,7 +1321,11 @@ function createWasm() {
         !isFileURI(wasmBinaryFile) &&
 #endif
         typeof fetch === 'function') {
+#if WASM_MODULE_CACHE
+      return fetchWasmResponse().then(function (response) {
+#else
       return fetch(wasmBinaryFile, { credentials: 'same-origin' }).then(function (response) {
+#endif
         var result = WebAssembly.instantiateStreaming(response, info);
 
 #if USE_OFFSET_CONVERTER
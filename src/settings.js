@@ -386,6 +386,17 @@ var SOCKET_WEBRTC = 0;
 // [link]
 var WEBSOCKET_URL = 'ws://';
 
+// If 1, small writes to SOCK_STREAM sockets are batched together and sent as a
+// single WebSocket message at the end of the current event loop task (or once
+// 64KB has accumulated), rather than as one WebSocket message per send() call.
+// This greatly reduces overhead for applications that send many small
+// packets, but means the peer can no longer rely on WebSocket message
+// boundaries matching send() calls (as is already the case for real TCP,
+// e.g. when going through websockify). Send errors that occur when the batch
+// is flushed close the connection rather than failing the send() call.
+// [link]
+var SOCKET_COALESCE_SENDS = 0;
+
 // If 1, the POSIX sockets API uses a native bridge process server to proxy sockets calls
 // from browser to native world.
 // [link]
@@ -891,6 +902,17 @@ var FORCE_FILESYSTEM = 0;
 // [link]
 var NODERAWFS = 0;
 
+// When a MEMFS file is mapped with MAP_SHARED, move its contents into the wasm
+// heap for as long as it stays mapped, so that mmap returns a pointer directly
+// to the file data instead of a copy of it.  Reads, writes and all shared
+// mappings of the file then see the same bytes, and munmap does not need to
+// write anything back.  The heap memory is returned once the last shared
+// mapping is unmapped.  The heap region is sized to the first shared mapping,
+// rounded up to a multiple of 64KB, and while the file is mapped it can't grow
+// past it: larger shared mappings fail with ENOMEM, and writes with ENOSPC.
+// [link]
+var MEMFS_SHARED_MMAP = 0;
+
 // This saves the compiled wasm module in a file with name
 //   $WASM_BINARY_NAME.$V8_VERSION.cached
 // and loads it on subsequent runs. This caches the compiled wasm code from
@@ -908,6 +930,21 @@ var NODERAWFS = 0;
 // [link]
 var NODE_CODE_CACHING = 0;
 
+// Caches the wasm binary in web and worker environments using the Cache
+// Storage API, keyed by a hash of the binary's contents that is computed at
+// link time.  Later page loads compile the cached response with streaming
+// compilation, which allows the browser to reuse the machine code it produced
+// the first time instead of compiling again.  Entries for previous builds of
+// the binary are removed once the new one has been stored, so a redeploy never
+// runs stale code.  Module['wasmFromCache'] is set to whether the binary came
+// from the cache.
+//  * Cache Storage is only available in secure contexts (https or localhost);
+//    elsewhere the binary is fetched as normal.
+//  * Pthreads receive the compiled module from the main thread and don't
+//    consult the cache themselves.
+// [link]
+var WASM_MODULE_CACHE = 0;
+
 // Functions that are explicitly exported. These functions are kept alive
 // through LLVM dead code elimination, and also made accessible outside of the
 // generated code even after running closure compiler (on "Module").  The
@@ -1507,6 +1544,24 @@ var PTHREAD_POOL_SIZE_STRICT = 1;
 // [link] - affects generated JS runtime code at link time
 var PTHREAD_POOL_DELAY_LOAD = 0;
 
+// If nonzero, the runtime keeps at least this many unused Workers loaded and
+// ready to host new threads. Any that PTHREAD_POOL_SIZE does not already
+// provide are spawned in the background after startup, and whenever
+// pthread_create() takes a Worker from the pool, a replacement is created and
+// loaded asynchronously the next time the main thread returns to the event
+// loop. This lets applications create threads synchronously without sizing
+// PTHREAD_POOL_SIZE for the largest number they will ever need at once, as
+// long as they do not create more than this many between returns to the event
+// loop.
+// [link] - affects generated JS runtime code at link time
+var PTHREAD_POOL_LOW_WATER = 0;
+
+// If nonzero, unused Workers that have been idle in the pool for this many
+// milliseconds are terminated to free their memory, as long as at least
+// PTHREAD_POOL_SIZE and PTHREAD_POOL_LOW_WATER Workers remain in the pool.
+// [link] - affects generated JS runtime code at link time
+var PTHREAD_POOL_IDLE_TIMEOUT = 0;
+
 // If not explicitly specified, this is the stack size to use for newly created
 // pthreads.  According to
 // http://man7.org/linux/man-pages/man3/pthread_create.3.html, default stack
@@ -1533,6 +1588,19 @@ var PTHREADS_PROFILING = 0;
 // [link]
 var ALLOW_BLOCKING_ON_MAIN_THREAD = 1;
 
+// If true, blocking futex waits on the main browser thread (for example when
+// locking a mutex that a pthread holds) suspend the program using Asyncify and
+// Atomics.waitAsync, and return to the browser event loop until the futex is
+// notified, instead of busy-waiting. Proxied calls from pthreads are then
+// handled by the event loop as usual. Requires ASYNCIFY, and adds
+// emscripten_futex_wait to ASYNCIFY_IMPORTS. Only waits made directly inside
+// main() or a ccall with {async: true} suspend (see
+// https://emscripten.org/docs/porting/asyncify.html); waits in other calls
+// into wasm from JS, where Atomics.waitAsync is not available, or while
+// another wait is already suspended, fall back to busy-waiting.
+// [link]
+var MAIN_THREAD_ASYNC_WAITS = 0;
+
 // If true, add in debug traces for diagnosing pthreads related issues.
 // [link]
 var PTHREADS_DEBUG = 0;
@@ -1574,6 +1642,24 @@ var PTHREADS_DEBUG = 0;
 // [link]
 var EVAL_CTORS = 0;
 
+// Runs the program under node at link time until it calls
+// emscripten_snapshot_point(), and replaces the data segments of the wasm
+// binary with the contents of memory at that point.  The program then starts
+// from the already-initialized state: global constructors are not run again,
+// and emscripten_snapshot_restored() returns 1, so that main() can skip the
+// initialization that led up to the snapshot point.  If the snapshot point is
+// not reached, the binary is left unchanged.
+//
+// Only linear memory is captured.  Anything the initialization did on the JS
+// side (files written to the virtual filesystem, open file descriptors,
+// functions added to the table, etc.) is not part of the snapshot, so the code
+// before the snapshot point should confine itself to computing data in memory.
+// Memory must not have grown beyond INITIAL_MEMORY by the snapshot point.
+// Global constructors must not call into JS (which rules out embind), since
+// they are not run again; the link fails if they do.
+// [link]
+var HEAP_SNAPSHOT = 0;
+
 // Is enabled, use the JavaScript TextDecoder API for string marshalling.
 // Enabled by default, set this to 0 to disable.
 // If set to 2, we assume TextDecoder is present and usable, and do not emit
@@ -1867,6 +1953,8 @@ var PRINTF_LONG_DOUBLE = 0;
 // emit the wasm2c .h file. The output filenames will be X.wasm.c, X.wasm.h
 // if your output is X.js or X.wasm (note the added .wasm. we make sure to emit,
 // which avoids trampling a C file).
+// Only MVP wasm features are supported, so this cannot be combined with
+// USE_PTHREADS.
 // [link]
 var WASM2C = 0;
 
@@ -1874,6 +1962,11 @@ var WASM2C = 0;
 // https://kripken.github.io/blog/wasm/2020/07/27/wasmboxc.html
 //
 //  * full: Normal full wasm2c sandboxing. This uses a signal handler if it can.
+//  * guard: Full sandboxing without explicit bounds checks. Memory is placed in
+//    a reservation of 8GB of address space, and out of bounds accesses fault
+//    on its inaccessible pages and are turned into traps by a signal handler.
+//    Requires a 64-bit POSIX system. (The output of full mode can also be
+//    switched to this by compiling it with -DWASM2C_GUARD_PAGES=1.)
 //  * mask: Masks loads and stores.
 //  * none: No sandboxing at all.
 var WASM2C_SANDBOXING = 'full';
@@ -1896,6 +1989,19 @@ var SEPARATE_DWARF_URL = '';
 // [link]
 var ERROR_ON_WASM_CHANGES_AFTER_LINK = 0;
 
+// Keep state from one link to the next in a directory next to the output
+// (named after it, with a .linkstate suffix), and use it to skip work whose
+// inputs have not changed, for a faster edit-compile-run loop:
+//  * wasm-ld is not run again if its command line and its input files are the
+//    same as in the previous link. This helps when only JS inputs changed.
+//  * The JS compiler is not run again if the settings, which include the
+//    JS library symbols that the wasm imports, and the JS library files are
+//    the same. This helps when only native code changed.
+//  * At -O0 and -O1, debug info and the producers section are not stripped
+//    from the wasm, as that would mean another pass over the whole binary.
+// [link]
+var INCREMENTAL_LINK = 0;
+
 // Whether the program should abort when an unhandled WASM exception is encountered.
 // This makes the Emscripten program behave more like a native program where the OS
 // would terminate the process and no further code can be executed when an unhandled
@@ -215,3 +215,10 @@ var HAS_MAIN = 0;
 
 // Set to true if we are linking as C++ and including C++ stdlibs
 var LINK_AS_CXX = 0;
+
+// The directory that INCREMENTAL_LINK keeps its state in.
+var LINK_STATE_DIR = '';
+
+// The directory in which the JS compiler caches the preprocessed source of JS
+// library files.  Empty if the cache is not used.
+var JS_LIBRARY_CACHE_DIR = '';
@@ -23,6 +23,10 @@ var emscriptenThreadProfiler = {
     setInterval(function() { emscriptenThreadProfiler.updateUi() }, this.uiUpdateIntervalMsecs);
   },
 
+  // Time spent in each status by each thread at the previous UI update, so
+  // that the UI can show recent activity.
+  previousTimeInStatus: {},
+
   updateUi: function updateUi() {
     if (typeof PThread === 'undefined') {
       // Likely running threadprofiler on a singlethreaded build, or not
@@ -37,10 +41,12 @@ var emscriptenThreadProfiler = {
       threads.push(PThread.pthreads[i].threadInfoStruct);
     }
 
+    var previousTimeInStatus = {};
     for (var i = 0; i < threads.length; ++i) {
       var threadPtr = threads[i];
-      var profilerBlock = Atomics.load(HEAPU32, (threadPtr + 8 /* {{{ C_STRUCTS.pthread.profilerBlock }}}*/) >> 2);
-      var threadName = PThread.getThreadName(threadPtr);
+      var profile = PThread.getThreadProfile(threadPtr);
+      if (!profile) continue;
+      var threadName = profile['name'];
       if (threadName) {
         threadName = '"' + threadName + '" (0x' + threadPtr.toString(16) + ')';
       } else {
@@ -49,24 +55,46 @@ var emscriptenThreadProfiler = {
 
       str += 'Thread ' + threadName + ' now: ' + PThread.threadStatusAsString(threadPtr) + '. ';
 
-      var threadTimesInStatus = [];
+      var timeInStatus = profile['timeInStatus'];
+      var previous = this.previousTimeInStatus[threadPtr] || {};
+      previousTimeInStatus[threadPtr] = timeInStatus;
+      var recentTimeInStatus = {};
       var totalTime = 0;
-      for (var j = 0; j < 7/*EM_THREAD_STATUS_NUMFIELDS*/; ++j) {
-        threadTimesInStatus.push(HEAPF64[((profilerBlock + 16/*C_STRUCTS.thread_profiler_block.timeSpentInStatus*/) >> 3) + j]);
-        totalTime += threadTimesInStatus[j];
-        HEAPF64[((profilerBlock + 16/*C_STRUCTS.thread_profiler_block.timeSpentInStatus*/) >> 3) + j] = 0;
+      for (var status in timeInStatus) {
+        recentTimeInStatus[status] = timeInStatus[status] - (previous[status] || 0);
+        totalTime += recentTimeInStatus[status];
       }
       var recent = '';
-      if (threadTimesInStatus[1] > 0) recent += (threadTimesInStatus[1] / totalTime * 100.0).toFixed(1) + '% running. ';
-      if (threadTimesInStatus[2] > 0) recent += (threadTimesInStatus[2] / totalTime * 100.0).toFixed(1) + '% sleeping. ';
-      if (threadTimesInStatus[3] > 0) recent += (threadTimesInStatus[3] / totalTime * 100.0).toFixed(1) + '% waiting for futex. ';
-      if (threadTimesInStatus[4] > 0) recent += (threadTimesInStatus[4] / totalTime * 100.0).toFixed(1) + '% waiting for mutex. ';
-      if (threadTimesInStatus[5] > 0) recent += (threadTimesInStatus[5] / totalTime * 100.0).toFixed(1) + '% waiting for proxied ops. ';
+      if (recentTimeInStatus['running'] > 0) recent += (recentTimeInStatus['running'] / totalTime * 100.0).toFixed(1) + '% running. ';
+      if (recentTimeInStatus['sleeping'] > 0) recent += (recentTimeInStatus['sleeping'] / totalTime * 100.0).toFixed(1) + '% sleeping. ';
+      if (recentTimeInStatus['waitFutex'] > 0) recent += (recentTimeInStatus['waitFutex'] / totalTime * 100.0).toFixed(1) + '% waiting for futex. ';
+      if (recentTimeInStatus['waitMutex'] > 0) recent += (recentTimeInStatus['waitMutex'] / totalTime * 100.0).toFixed(1) + '% waiting for mutex. ';
+      if (recentTimeInStatus['waitProxy'] > 0) recent += (recentTimeInStatus['waitProxy'] / totalTime * 100.0).toFixed(1) + '% waiting for proxied ops. ';
       if (recent.length > 0) str += 'Recent activity: ' + recent;
       str += '<br />';
     }
+    this.previousTimeInStatus = previousTimeInStatus;
     this.threadProfilerDiv.innerHTML = str;
+  },
+
+  // Writes the JSON report from PThread.getProfileReport() to the given file.
+  writeReport: function writeReport(filename) {
+    if (typeof PThread === 'undefined') return;
+    require('fs').writeFileSync(filename, JSON.stringify(PThread.getProfileReport(), null, 2));
   }
 };
 
-if (typeof Module !== 'undefined' && typeof document !== 'undefined') emscriptenThreadProfiler.initialize();
+if (typeof Module !== 'undefined') {
+  Module['getThreadProfileReport'] = function() {
+    return PThread.getProfileReport();
+  };
+  if (typeof document !== 'undefined') {
+    emscriptenThreadProfiler.initialize();
+  } else if (ENVIRONMENT_IS_NODE && typeof PThread !== 'undefined' && !ENVIRONMENT_IS_PTHREAD && process.env['EMSCRIPTEN_THREADPROFILER_REPORT']) {
+    // In headless runs, write the report when the process exits, e.g.
+    //   EMSCRIPTEN_THREADPROFILER_REPORT=profile.json node a.out.js
+    process.on('exit', function() {
+      emscriptenThreadProfiler.writeReport(process.env['EMSCRIPTEN_THREADPROFILER_REPORT']);
+    });
+  }
+}
@@ -119,6 +119,7 @@ self.onmessage = function(e) {
 
 #if MAIN_MODULE
       Module['dynamicLibraries'] = e.data.dynamicLibraries;
+      Module['compiledDylibs'] = e.data.compiledDylibs;
 #endif
 
       {{{ makeAsmImportsAccessInPthread('wasmMemory') }}} = e.data.wasmMemory;
@@ -95,6 +95,20 @@ void _embind_register_memory_view(
     unsigned typedArrayIndex,
     const char* name);
 
+void _embind_register_typed_array_vector(
+    TYPEID vectorType,
+    TYPEID vectorViewType,
+    unsigned typedArrayIndex,
+    const char* name,
+    const char* constructorSignature,
+    GenericFunction constructor,
+    const char* dataSignature,
+    GenericFunction data,
+    const char* sizeSignature,
+    GenericFunction size,
+    const char* destructorSignature,
+    GenericFunction destructor);
+
 void _embind_register_function(
     const char* name,
     unsigned argCount,
@@ -293,6 +307,30 @@ template<typename Slot>
 struct allow_raw_pointer : public allow_raw_pointers {
 };
 
+namespace internal {
+
+template<typename VectorType>
+struct TypedArrayView {
+};
+
+} // end namespace internal
+
+// Returns a std::vector registered with register_vector_as_typed_array as a
+// typed array that aliases the vector's storage, rather than as a copy of it.
+// The vector is freed by calling delete() on the array, as with other embind
+// objects, and like typed_memory_view the array becomes invalid if memory
+// grows.
+struct return_typed_array_view {
+    template<typename InputType, int Index>
+    struct Transform {
+        typedef typename std::conditional<
+            Index == ret_val::index,
+            internal::TypedArrayView<typename internal::Canonicalized<InputType>::type>,
+            InputType
+        >::type type;
+    };
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // select_overload and select_const
 ////////////////////////////////////////////////////////////////////////////////
@@ -1769,6 +1807,48 @@ class_<std::vector<T>> register_vector(const char* name) {
         ;
 }
 
+namespace internal {
+
+template<typename VectorType>
+struct TypedArrayVectorAccess {
+    static typename VectorType::value_type* data(VectorType* v) {
+        return v->data();
+    }
+
+    static size_t size(VectorType* v) {
+        return v->size();
+    }
+};
+
+} // end namespace internal
+
+// Binds std::vector<T>, for arithmetic T, to JS typed arrays: vectors are
+// returned to JS as a copy in a typed array of the matching type, and typed
+// arrays (or plain arrays) passed in are copied into a new vector in one go.
+template<typename T>
+void register_vector_as_typed_array(const char* name) {
+    using namespace internal;
+    typedef std::vector<T> VecType;
+
+    auto constructor = &raw_constructor<VecType, size_t>;
+    auto data = &TypedArrayVectorAccess<VecType>::data;
+    auto size = &TypedArrayVectorAccess<VecType>::size;
+    auto destructor = &raw_destructor<VecType>;
+    _embind_register_typed_array_vector(
+        TypeID<VecType>::get(),
+        TypeID<TypedArrayView<VecType>>::get(),
+        getTypedArrayIndex<T>(),
+        name,
+        getSignature(constructor),
+        reinterpret_cast<GenericFunction>(constructor),
+        getSignature(data),
+        reinterpret_cast<GenericFunction>(data),
+        getSignature(size),
+        reinterpret_cast<GenericFunction>(size),
+        getSignature(destructor),
+        reinterpret_cast<GenericFunction>(destructor));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MAPS
 ////////////////////////////////////////////////////////////////////////////////
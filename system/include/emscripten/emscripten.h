@@ -176,6 +176,13 @@ void emscripten_dlopen(const char *filename, int flags, void* user_data, em_dlop
 void emscripten_throw_number(double number);
 void emscripten_throw_string(const char *utf8String);
 
+// Marks the point at which the initialized state of memory is captured when
+// linking with -sHEAP_SNAPSHOT.  The program is then started from that state,
+// and emscripten_snapshot_restored() returns 1 so that initialization leading
+// up to the snapshot point can be skipped.
+void emscripten_snapshot_point(void);
+int emscripten_snapshot_restored(void);
+
 /* ===================================== */
 /* Internal APIs. Be careful with these. */
 /* ===================================== */
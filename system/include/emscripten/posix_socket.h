@@ -1,5 +1,7 @@
 #pragma once
 
+#include <poll.h>
+
 #include "websocket.h"
 
 #ifdef __cplusplus
@@ -8,6 +10,14 @@ extern "C" {
 
 EMSCRIPTEN_RESULT emscripten_init_websocket_to_posix_socket_bridge(const char *bridgeUrl);
 
+// If enabled, send(), sendto() and sendmsg() return as soon as the call has been posted to the bridge instead of
+// waiting for a round trip to complete. An error from such a send is reported by the next send call on the same
+// socket. Disabled by default.
+void emscripten_websocket_to_posix_socket_bridge_set_pipelined_sends(EM_BOOL enabled);
+
+// Same as poll(), but for sockets created via the bridge. All the given sockets are polled with a single round trip.
+int emscripten_websocket_to_posix_socket_bridge_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+#include <type_traits>
+#include <utility>
+#endif
+
+// A work-stealing task scheduler that runs tasks on a set of worker threads.
+//
+// Each worker thread, and the main runtime thread, has its own deque of tasks.
+// A thread pushes the tasks it creates onto its own deque and takes its next
+// task from there, while idle workers steal the oldest tasks from the other
+// deques, and sleep on a futex when there is nothing to steal. A thread that
+// waits for tasks to finish, including the main thread, runs queued tasks in
+// the meantime rather than blocking.
+//
+// The workers are ordinary pthreads, so when the scheduler is started from the
+// main thread, build with -s PTHREAD_POOL_SIZE=N (N >= the number of workers)
+// to let them start without first returning to the browser event loop. Until
+// they have started, the main thread runs its tasks itself. Tasks created on
+// threads that are not part of the scheduler, and all tasks in builds without
+// threads, run immediately on the calling thread.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*em_task_func)(void *arg);
+typedef void (*em_parallel_for_func)(size_t begin, size_t end, void *arg);
+
+// A set of tasks that can be waited for together.
+typedef struct em_task_group {
+  int pending; // Number of tasks run on the group that have not finished.
+} em_task_group;
+
+#define EM_TASK_GROUP_INIT { 0 }
+
+// Starts the scheduler with the given number of worker threads. Pass a negative
+// number to use one worker per logical core, not counting the calling thread.
+// Returns the number of workers that were started, which can be lower than
+// requested if threads could not be created. Must be called from the main
+// runtime thread.
+int emscripten_scheduler_init(int num_workers);
+
+// Stops and joins the worker threads. All task groups must have been waited
+// for first.
+void emscripten_scheduler_shutdown(void);
+
+// Returns the number of worker threads, or 0 if the scheduler is not running.
+int emscripten_scheduler_num_workers(void);
+
+// Queues func(arg) to run as part of the given group.
+void emscripten_task_group_run(em_task_group *group, em_task_func func, void *arg);
+
+// Returns once every task run on the group has finished, including tasks that
+// those tasks added to it. Runs other queued tasks while waiting.
+void emscripten_task_group_wait(em_task_group *group);
+
+// Calls func(chunk_begin, chunk_end, arg) for consecutive chunks of up to grain
+// indices that together cover [begin, end), in parallel, and returns once they
+// have all finished. The calling thread processes chunks too.
+void emscripten_parallel_for(size_t begin, size_t end, size_t grain, em_parallel_for_func func, void *arg);
+
+#ifdef __cplusplus
+} // extern "C"
+
+namespace emscripten {
+
+// C++ interface to em_task_group. Runs any callable, and waits for its tasks
+// when destroyed.
+class task_group {
+public:
+  task_group() = default;
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  ~task_group() {
+    wait();
+  }
+
+  template<typename F>
+  void run(F&& f) {
+    using Func = typename std::decay<F>::type;
+    emscripten_task_group_run(&group, &invoke<Func>, new Func(std::forward<F>(f)));
+  }
+
+  void wait() {
+    emscripten_task_group_wait(&group);
+  }
+
+private:
+  template<typename Func>
+  static void invoke(void* arg) {
+    Func* f = static_cast<Func*>(arg);
+    (*f)();
+    delete f;
+  }
+
+  em_task_group group = EM_TASK_GROUP_INIT;
+};
+
+// Calls f(i) for every i in [begin, end), in parallel, handing out the indices
+// in chunks of grain.
+template<typename F>
+void parallel_for(size_t begin, size_t end, F&& f, size_t grain = 1) {
+  emscripten_parallel_for(begin, end, grain, [](size_t chunk_begin, size_t chunk_end, void* arg) {
+    auto& f = *static_cast<typename std::remove_reference<F>::type*>(arg);
+    for (size_t i = chunk_begin; i < chunk_end; i++) {
+      f(i);
+    }
+  }, const_cast<void*>(static_cast<const void*>(&f)));
+}
+
+} // namespace emscripten
+
+#endif
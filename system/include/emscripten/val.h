@@ -394,11 +394,11 @@ namespace emscripten {
         val(const val& v)
             : handle(v.handle)
         {
-            internal::_emval_incref(handle);
+            incref(handle);
         }
 
         ~val() {
-            internal::_emval_decref(handle);
+            decref(handle);
         }
 
         EM_VAL as_handle() const {
@@ -406,15 +406,15 @@ namespace emscripten {
         }
 
         val& operator=(val&& v) & {
-            internal::_emval_decref(handle);
+            decref(handle);
             handle = v.handle;
             v.handle = 0;
             return *this;
         }
 
         val& operator=(const val& v) & {
-            internal::_emval_incref(v.handle);
-            internal::_emval_decref(handle);
+            incref(v.handle);
+            decref(handle);
             handle = v.handle;
             return *this;
         }
@@ -615,6 +615,25 @@ namespace emscripten {
                     argv));
         }
 
+        // Moved-from vals (handle 0) and the reserved handles for undefined,
+        // null, true and false are not reference counted, so skip the call
+        // into JS for them.
+        static bool is_counted(EM_VAL handle) {
+            return reinterpret_cast<uintptr_t>(handle) > internal::_EMVAL_FALSE;
+        }
+
+        static void incref(EM_VAL handle) {
+            if (is_counted(handle)) {
+                internal::_emval_incref(handle);
+            }
+        }
+
+        static void decref(EM_VAL handle) {
+            if (is_counted(handle)) {
+                internal::_emval_decref(handle);
+            }
+        }
+
         EM_VAL handle;
 
         friend struct internal::BindingType<val>;
@@ -625,9 +644,16 @@ namespace emscripten {
         struct BindingType<val> {
             typedef EM_VAL WireType;
             static WireType toWireType(const val& v) {
-                _emval_incref(v.handle);
+                val::incref(v.handle);
                 return v.handle;
             }
+            // The JS side takes ownership of the handle, so a temporary can
+            // hand over its reference instead of taking a new one.
+            static WireType toWireType(val&& v) {
+                WireType handle = v.handle;
+                v.handle = 0;
+                return handle;
+            }
             static val fromWireType(WireType v) {
                 return val::take_ownership(v);
             }
@@ -403,6 +403,33 @@ namespace emscripten {
                         (sizeof(T) == 1 || sizeof(T) == 2 ||
                          sizeof(T) == 4 || sizeof(T) == 8));
         }
+
+        // matches getTypedArrayType in embind.js
+        enum TypedArrayIndex {
+            Int8Array,
+            Uint8Array,
+            Int16Array,
+            Uint16Array,
+            Int32Array,
+            Uint32Array,
+            Float32Array,
+            Float64Array,
+            // Only available if WASM_BIGINT
+            Int64Array,
+            Uint64Array,
+        };
+
+        template<typename T>
+        constexpr TypedArrayIndex getTypedArrayIndex() {
+            static_assert(typeSupportsMemoryView<T>(), "type does not map to a typed array");
+            return std::is_floating_point<T>::value
+                ? (sizeof(T) == 4 ? Float32Array : Float64Array)
+                : (sizeof(T) == 1
+                    ? (std::is_signed<T>::value ? Int8Array : Uint8Array)
+                    : (sizeof(T) == 2 ? (std::is_signed<T>::value ? Int16Array : Uint16Array)
+                        : (sizeof(T) == 4 ? (std::is_signed<T>::value ? Int32Array : Uint32Array)
+                            : (std::is_signed<T>::value ? Int64Array : Uint64Array))));
+        }
     }
 
     template<typename ElementType>
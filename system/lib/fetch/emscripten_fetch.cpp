@@ -9,8 +9,10 @@
 #include <emscripten/html5.h>
 #include <emscripten/threading.h>
 #include <emscripten/console.h>
+#include <limits.h>
 #include <math.h>
 #include <memory.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -20,6 +22,7 @@ extern "C" {
 // enable internal debugging. #define FETCH_DEBUG
 
 static void fetch_free(emscripten_fetch_t* fetch);
+static void fetch_free_memory(emscripten_fetch_t* fetch);
 
 // APIs defined in JS
 void emscripten_start_fetch(emscripten_fetch_t* fetch);
@@ -27,35 +30,375 @@ int32_t _emscripten_fetch_get_response_headers_length(int32_t fetchID);
 int32_t _emscripten_fetch_get_response_headers(int32_t fetchID, int32_t dst, int32_t dstSizeBytes);
 void _emscripten_fetch_free(unsigned int);
 
+#if __EMSCRIPTEN_PTHREADS__
+// Fetches that the calling thread needs to block on run on a dedicated fetch
+// thread: synchronous fetches that access IndexedDB, whose API is asynchronous
+// in every Worker, and waitable fetches. Other threads add them to the fetch
+// queue, and the fetch thread starts them from its event loop, at most
+// FETCH_THREAD_MAX_ACTIVE at a time. When one completes, its callbacks are
+// queued to run on the thread that started it, and that thread is woken if it
+// is waiting for it in emscripten_fetch_wait().
+//
+// The XHR objects of these fetches live on the fetch thread, so that is also
+// where their response headers are read and where they are freed.
+//
+// fetch->__proxyState is 0 for fetches that run on the calling thread, 1 while
+// a fetch is queued or running on the fetch thread, and 2 once it finished.
+// Closing a fetch sets it to 3; if the fetch was still running, the fetch
+// thread then aborts and frees it, or sets 4 if it finished in the meantime.
+
+// Browsers only open about this many connections to the same host at a time
+// anyway.
+#define FETCH_THREAD_MAX_ACTIVE 6
+
+void _emscripten_fetch_init_thread(void (*onready)(void));
+int32_t _emscripten_fetch_abort(emscripten_fetch_t* fetch);
+
+struct proxied_fetch {
+  emscripten_fetch_t* fetch;
+  pthread_t caller;
+  uint32_t attributes;
+  // The user's callbacks, which are replaced in fetch->__attributes while the
+  // fetch runs on the fetch thread.
+  void (*onsuccess)(emscripten_fetch_t* fetch);
+  void (*onerror)(emscripten_fetch_t* fetch);
+  void (*onprogress)(emscripten_fetch_t* fetch);
+  void (*onreadystatechange)(emscripten_fetch_t* fetch);
+  // Set when the fetch was closed while its XHR could not be aborted, so that
+  // it is freed once it completes.
+  bool closed;
+};
+
 struct emscripten_fetch_queue {
-  emscripten_fetch_t** queuedOperations;
+  proxied_fetch** queuedOperations;
   int numQueuedItems;
   int queueSize;
 };
 
+// Guards the fetch queue and the state of the fetch thread.
+static pthread_mutex_t fetch_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t fetch_thread;
+static bool fetch_thread_started;
+static bool fetch_thread_ready;
+static bool fetch_queue_drain_pending;
+
+// Only changed on the fetch thread, with fetch_queue_lock held, so that other
+// threads can look fetches up in it under the lock.
+static proxied_fetch* active_fetches[FETCH_THREAD_MAX_ACTIVE];
+static int num_active_fetches;
+
 emscripten_fetch_queue* _emscripten_get_fetch_queue() {
-  static thread_local emscripten_fetch_queue g_queue;
+  static emscripten_fetch_queue g_queue;
+  return &g_queue;
+}
+
+static void start_queued_fetches();
 
-  if (!g_queue.queuedOperations) {
-    g_queue.queueSize = 64;
-    g_queue.numQueuedItems = 0;
-    g_queue.queuedOperations =
-      (emscripten_fetch_t**)malloc(sizeof(emscripten_fetch_t*) * g_queue.queueSize);
+static proxied_fetch* take_active_fetch(emscripten_fetch_t* fetch) {
+  for (int i = 0; i < num_active_fetches; ++i) {
+    proxied_fetch* proxied = active_fetches[i];
+    if (proxied->fetch == fetch) {
+      active_fetches[i] = active_fetches[--num_active_fetches];
+      return proxied;
+    }
   }
-  return &g_queue;
+  return 0;
+}
+
+static proxied_fetch* find_active_fetch(emscripten_fetch_t* fetch) {
+  for (int i = 0; i < num_active_fetches; ++i) {
+    if (active_fetches[i]->fetch == fetch)
+      return active_fetches[i];
+  }
+  return 0;
+}
+
+// Returns the index of the fetch in the fetch queue, or -1. Called with
+// fetch_queue_lock held, as is take_queued_fetch().
+static int find_queued_fetch(emscripten_fetch_t* fetch) {
+  emscripten_fetch_queue* queue = _emscripten_get_fetch_queue();
+  for (int i = 0; i < queue->numQueuedItems; ++i) {
+    if (queue->queuedOperations[i]->fetch == fetch)
+      return i;
+  }
+  return -1;
 }
 
-void emscripten_proxy_fetch(emscripten_fetch_t* fetch) {
-  // TODO: mutex lock
+static proxied_fetch* take_queued_fetch(emscripten_fetch_t* fetch) {
+  int i = find_queued_fetch(fetch);
+  if (i < 0)
+    return 0;
   emscripten_fetch_queue* queue = _emscripten_get_fetch_queue();
-  //	TODO handle case when queue->numQueuedItems >= queue->queueSize
-  queue->queuedOperations[queue->numQueuedItems++] = fetch;
+  proxied_fetch* proxied = queue->queuedOperations[i];
+  queue->numQueuedItems--;
+  memmove(queue->queuedOperations + i, queue->queuedOperations + i + 1,
+          (queue->numQueuedItems - i) * sizeof(proxied_fetch*));
+  return proxied;
+}
+
+// Called with fetch_queue_lock held, so that emscripten_fetch_close() either
+// finds the callback queued, and runs it before freeing the fetch, or stops us
+// from queuing it.
+static void forward_callback(proxied_fetch* proxied, void (*callback)(emscripten_fetch_t*)) {
+  if (callback && proxied->fetch->__proxyState == 1)
+    emscripten_dispatch_to_thread_async(proxied->caller, EM_FUNC_SIG_VI, callback, 0, proxied->fetch);
+}
+
+static void proxied_fetch_done(emscripten_fetch_t* fetch, bool success) {
+  pthread_mutex_lock(&fetch_queue_lock);
+  proxied_fetch* proxied = take_active_fetch(fetch);
+  bool closed = fetch->__proxyState == 3;
+  if (closed) {
+    // If close_on_fetch_thread() has not run yet, leave the fetch for it.
+    if (!proxied->closed)
+      fetch->__proxyState = 4;
+  } else {
+    fetch->__attributes.attributes = proxied->attributes;
+    fetch->__attributes.onsuccess = proxied->onsuccess;
+    fetch->__attributes.onerror = proxied->onerror;
+    fetch->__attributes.onprogress = proxied->onprogress;
+    fetch->__attributes.onreadystatechange = proxied->onreadystatechange;
+    // Queue the callback before waking the caller, which runs it as soon as its
+    // wait returns.
+    forward_callback(proxied, success ? proxied->onsuccess : proxied->onerror);
+    fetch->__proxyState = 2;
+    emscripten_futex_wake(&fetch->__proxyState, INT_MAX);
+  }
+  pthread_mutex_unlock(&fetch_queue_lock);
+  if (closed && proxied->closed)
+    fetch_free(fetch);
+  free(proxied);
+  start_queued_fetches();
+}
+
+static void proxied_fetch_success(emscripten_fetch_t* fetch) {
+  proxied_fetch_done(fetch, true);
+}
+
+static void proxied_fetch_error(emscripten_fetch_t* fetch) {
+  proxied_fetch_done(fetch, false);
+}
+
+static void proxied_fetch_progress(emscripten_fetch_t* fetch) {
+  pthread_mutex_lock(&fetch_queue_lock);
+  proxied_fetch* proxied = find_active_fetch(fetch);
+  forward_callback(proxied, proxied->onprogress);
+  pthread_mutex_unlock(&fetch_queue_lock);
+}
+
+static void proxied_fetch_readystatechange(emscripten_fetch_t* fetch) {
+  pthread_mutex_lock(&fetch_queue_lock);
+  proxied_fetch* proxied = find_active_fetch(fetch);
+  forward_callback(proxied, proxied->onreadystatechange);
+  pthread_mutex_unlock(&fetch_queue_lock);
+}
+
+// Runs on the fetch thread.
+static void start_queued_fetches() {
+  proxied_fetch* starting[FETCH_THREAD_MAX_ACTIVE];
+  int numStarting = 0;
+  pthread_mutex_lock(&fetch_queue_lock);
+  fetch_queue_drain_pending = false;
+  emscripten_fetch_queue* queue = _emscripten_get_fetch_queue();
+  int numTaken = 0;
+  while (numTaken < queue->numQueuedItems && num_active_fetches < FETCH_THREAD_MAX_ACTIVE) {
+    proxied_fetch* proxied = queue->queuedOperations[numTaken++];
+    active_fetches[num_active_fetches++] = proxied;
+    starting[numStarting++] = proxied;
+  }
+  queue->numQueuedItems -= numTaken;
+  memmove(queue->queuedOperations, queue->queuedOperations + numTaken,
+          queue->numQueuedItems * sizeof(proxied_fetch*));
+  pthread_mutex_unlock(&fetch_queue_lock);
+
+  // Start the fetches without holding the lock, as a fetch can fail, and so
+  // complete, straight away.
+  for (int i = 0; i < numStarting; ++i) {
 #ifdef FETCH_DEBUG
-  emscripten_console_logf("Queued fetch to fetch-worker to process. There are "
+    emscripten_console_logf("fetch: fetch thread starting %s", starting[i]->fetch->url);
+#endif
+    emscripten_start_fetch(starting[i]->fetch);
+  }
+}
+
+// Runs on the fetch thread once it can access IndexedDB.
+static void fetch_thread_ready_to_start() {
+  pthread_mutex_lock(&fetch_queue_lock);
+  fetch_thread_ready = true;
+  pthread_mutex_unlock(&fetch_queue_lock);
+  start_queued_fetches();
+}
+
+static void* fetch_thread_main(void* arg) {
+  _emscripten_fetch_init_thread(fetch_thread_ready_to_start);
+  // Keep running the fetches from this thread's event loop.
+  emscripten_exit_with_live_runtime();
+  return 0;
+}
+
+// Queues the fetch to run on the fetch thread, starting the thread first if
+// needed. Returns false if the thread cannot be started.
+static bool emscripten_proxy_fetch(emscripten_fetch_t* fetch) {
+  proxied_fetch* proxied = (proxied_fetch*)malloc(sizeof(proxied_fetch));
+  if (!proxied)
+    return false;
+  proxied->fetch = fetch;
+  proxied->caller = pthread_self();
+  proxied->attributes = fetch->__attributes.attributes;
+  proxied->onsuccess = fetch->__attributes.onsuccess;
+  proxied->onerror = fetch->__attributes.onerror;
+  proxied->onprogress = fetch->__attributes.onprogress;
+  proxied->onreadystatechange = fetch->__attributes.onreadystatechange;
+  proxied->closed = false;
+
+  pthread_mutex_lock(&fetch_queue_lock);
+  if (!fetch_thread_started) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    fetch_thread_started = pthread_create(&fetch_thread, &attr, fetch_thread_main, 0) == 0;
+    pthread_attr_destroy(&attr);
+    if (!fetch_thread_started) {
+      pthread_mutex_unlock(&fetch_queue_lock);
+      free(proxied);
+      return false;
+    }
+  }
+  emscripten_fetch_queue* queue = _emscripten_get_fetch_queue();
+  if (queue->numQueuedItems == queue->queueSize) {
+    int newSize = queue->queueSize ? queue->queueSize * 2 : 64;
+    proxied_fetch** newOperations =
+      (proxied_fetch**)realloc(queue->queuedOperations, sizeof(proxied_fetch*) * newSize);
+    if (!newOperations) {
+      pthread_mutex_unlock(&fetch_queue_lock);
+      free(proxied);
+      return false;
+    }
+    queue->queuedOperations = newOperations;
+    queue->queueSize = newSize;
+  }
+  // The caller does the blocking, so that the fetch thread can run several
+  // XHRs at once.
+  fetch->__attributes.attributes &= ~EMSCRIPTEN_FETCH_SYNCHRONOUS;
+  fetch->__attributes.onsuccess = proxied_fetch_success;
+  fetch->__attributes.onerror = proxied_fetch_error;
+  fetch->__attributes.onprogress = proxied_fetch_progress;
+  fetch->__attributes.onreadystatechange = proxied_fetch_readystatechange;
+  fetch->__proxyState = 1; // sent to the fetch thread.
+  queue->queuedOperations[queue->numQueuedItems++] = proxied;
+#ifdef FETCH_DEBUG
+  emscripten_console_logf("Queued fetch to fetch thread to process. There are "
                           "now %d operations in the queue.", queue->numQueuedItems);
 #endif
-  // TODO: mutex unlock
+  // Until it is ready, the fetch thread starts the queued fetches by itself.
+  if (fetch_thread_ready && !fetch_queue_drain_pending) {
+    fetch_queue_drain_pending = true;
+    emscripten_dispatch_to_thread_async(fetch_thread, EM_FUNC_SIG_V, start_queued_fetches, 0);
+  }
+  pthread_mutex_unlock(&fetch_queue_lock);
+  return true;
+}
+
+struct response_headers_request {
+  int32_t fetchID;
+  int32_t dst;
+  int32_t dstSizeBytes;
+  int32_t result;
+  _Atomic uint32_t done;
+};
+
+static void get_response_headers_on_fetch_thread(response_headers_request* request) {
+  if (request->dst) {
+    request->result = _emscripten_fetch_get_response_headers(request->fetchID, request->dst, request->dstSizeBytes);
+  } else {
+    request->result = _emscripten_fetch_get_response_headers_length(request->fetchID);
+  }
+  request->done = 1;
+  emscripten_futex_wake(&request->done, 1);
+}
+
+// Reads the response headers of a fetch that ran on the fetch thread, or their
+// length if dst is null.
+static int32_t get_proxied_response_headers(int32_t fetchID, int32_t dst, int32_t dstSizeBytes) {
+  response_headers_request request = { fetchID, dst, dstSizeBytes, 0, 0 };
+  emscripten_dispatch_to_thread(fetch_thread, EM_FUNC_SIG_VI, get_response_headers_on_fetch_thread, 0, &request);
+  while (!request.done)
+    emscripten_futex_wait(&request.done, 0, INFINITY);
+  return request.result;
+}
+
+static void free_on_fetch_thread(unsigned int id) {
+  _emscripten_fetch_free(id);
+}
+
+// Runs on the fetch thread after emscripten_fetch_close() of a fetch that was
+// queued or running here.
+static void close_on_fetch_thread(emscripten_fetch_t* fetch) {
+  pthread_mutex_lock(&fetch_queue_lock);
+  proxied_fetch* proxied = 0;
+  bool started = false;
+  if (fetch->__proxyState == 3) {
+    proxied = take_queued_fetch(fetch);
+    if (!proxied) {
+      proxied = find_active_fetch(fetch);
+      started = true;
+    }
+  }
+  pthread_mutex_unlock(&fetch_queue_lock);
+
+  if (!proxied) {
+    // It completed after it was closed.
+    fetch_free(fetch);
+    return;
+  }
+  if (!started) {
+    // Nothing was done for it in JS yet.
+    free(proxied);
+    fetch_free_memory(fetch);
+    return;
+  }
+  if (!_emscripten_fetch_abort(fetch)) {
+    // There is no XHR in flight to abort, because the fetch is accessing
+    // IndexedDB, so free it when that completes.
+    proxied->closed = true;
+    return;
+  }
+  pthread_mutex_lock(&fetch_queue_lock);
+  take_active_fetch(fetch);
+  pthread_mutex_unlock(&fetch_queue_lock);
+  free(proxied);
+  fetch_free(fetch);
+  start_queued_fetches();
+}
+
+// Closes a fetch that was queued or running on the fetch thread, from the
+// thread that started it. Returns false if the fetch finished in the meantime,
+// in which case it is closed as usual.
+static bool close_proxied_fetch(emscripten_fetch_t* fetch) {
+  pthread_mutex_lock(&fetch_queue_lock);
+  if (fetch->__proxyState != 1) {
+    pthread_mutex_unlock(&fetch_queue_lock);
+    return false;
+  }
+  int queued = find_queued_fetch(fetch);
+  proxied_fetch* proxied =
+    queued >= 0 ? _emscripten_get_fetch_queue()->queuedOperations[queued] : find_active_fetch(fetch);
+  void (*onerror)(emscripten_fetch_t*) = proxied->onerror;
+  // The fetch thread forwards no more callbacks from now on.
+  fetch->__proxyState = 3;
+  pthread_mutex_unlock(&fetch_queue_lock);
+
+  // Run the callbacks it forwarded before, while the fetch is still valid.
+  emscripten_current_thread_process_queued_calls();
+  if (onerror) {
+    fetch->status = (unsigned short)-1;
+    strcpy(fetch->statusText, "aborted with emscripten_fetch_close()");
+    onerror(fetch);
+  }
+  emscripten_dispatch_to_thread_async(fetch_thread, EM_FUNC_SIG_VI, close_on_fetch_thread, 0, fetch);
+  return true;
 }
+#endif // __EMSCRIPTEN_PTHREADS__
 
 void emscripten_fetch_attr_init(emscripten_fetch_attr_t* fetch_attr) {
   memset(fetch_attr, 0, sizeof(emscripten_fetch_attr_t));
@@ -141,26 +484,13 @@ emscripten_fetch_t* emscripten_fetch(emscripten_fetch_attr_t* fetch_attr, const
 
 #undef STRDUP_OR_ABORT
 
-// In asm.js we can use a fetch worker, which is created from the main asm.js
-// code. That lets us do sync operations by blocking on the worker etc.
-// In the wasm backend we don't have a fetch worker implemented yet, however,
-// we can still do basic synchronous fetches in the same places: if we can
-// block on another thread then we aren't the main thread, and if we aren't
-// the main thread then synchronous xhrs are legitimate.
-#if __EMSCRIPTEN_PTHREADS__ && !defined(__wasm__)
+#if __EMSCRIPTEN_PTHREADS__
   const bool waitable = (fetch_attr->attributes & EMSCRIPTEN_FETCH_WAITABLE) != 0;
-  // Depending on the type of fetch, we can either perform it in the same Worker/thread than the
-  // caller, or we might need to run it in a separate Worker. There is a dedicated fetch worker that
-  // is available for the fetch, but in some scenarios it might be desirable to run in the same
-  // Worker as the caller, so deduce here whether to run the fetch in this thread, or if we need to
-  // use the fetch-worker instead.
-  if (waitable // Waitable fetches can be synchronously waited on, so must always be proxied
-      || (synchronous &&
-           (readFromIndexedDB || writeToIndexedDB))) // Synchronous IndexedDB access needs proxying
-  {
-    fetch->__proxyState = 1; // sent to proxy worker.
-    emscripten_proxy_fetch(fetch);
-
+  // Waitable fetches can be synchronously waited on, so must always be
+  // proxied, and so must synchronous IndexedDB access. Synchronous XHRs are
+  // fine to do on the calling thread, as it cannot be the main browser thread.
+  if ((waitable || (synchronous && (readFromIndexedDB || writeToIndexedDB))) &&
+      emscripten_proxy_fetch(fetch)) {
     if (synchronous)
       emscripten_fetch_wait(fetch, INFINITY);
   } else
@@ -174,8 +504,11 @@ EMSCRIPTEN_RESULT emscripten_fetch_wait(emscripten_fetch_t* fetch, double timeou
   if (!fetch)
     return EMSCRIPTEN_RESULT_INVALID_PARAM;
   uint32_t proxyState = fetch->__proxyState;
-  if (proxyState == 2)
+  if (proxyState == 2) {
+    // Run the callbacks that the fetch thread queued for us.
+    emscripten_current_thread_process_queued_calls();
     return EMSCRIPTEN_RESULT_SUCCESS; // already finished.
+  }
   if (proxyState != 1)
     return EMSCRIPTEN_RESULT_INVALID_PARAM; // the fetch should be ongoing?
 #ifdef FETCH_DEBUG
@@ -198,10 +531,10 @@ EMSCRIPTEN_RESULT emscripten_fetch_wait(emscripten_fetch_t* fetch, double timeou
   emscripten_console_log("fetch: emscripten_fetch_wait done..");
 #endif
 
-  if (proxyState == 2)
-    return EMSCRIPTEN_RESULT_SUCCESS;
-  else
+  if (proxyState != 2)
     return EMSCRIPTEN_RESULT_FAILED;
+  emscripten_current_thread_process_queued_calls();
+  return EMSCRIPTEN_RESULT_SUCCESS;
 #else
   if (fetch->readyState >= 4 /*XMLHttpRequest.readyState.DONE*/)
     return EMSCRIPTEN_RESULT_SUCCESS; // already finished.
@@ -220,8 +553,21 @@ EMSCRIPTEN_RESULT emscripten_fetch_close(emscripten_fetch_t* fetch) {
   if (!fetch)
     return EMSCRIPTEN_RESULT_SUCCESS; // Closing null pointer is ok, same as with free().
 
+  bool finished = false;
 #if __EMSCRIPTEN_PTHREADS__
-  fetch->__proxyState = 0;
+  // Closing again from a callback that runs below.
+  if (fetch->__proxyState == 3)
+    return EMSCRIPTEN_RESULT_SUCCESS;
+  // A fetch on the fetch thread is aborted and freed there.
+  if (fetch->__proxyState == 1 && close_proxied_fetch(fetch))
+    return EMSCRIPTEN_RESULT_SUCCESS;
+  if (fetch->__proxyState == 2) {
+    // Run the callbacks that the fetch thread queued for us before the fetch
+    // is freed. They have reported how it finished already.
+    fetch->__proxyState = 3;
+    emscripten_current_thread_process_queued_calls();
+    finished = true;
+  }
 #endif
   // This function frees the fetch pointer so that it is invalid to access it anymore.
   // Use a few key fields as an integrity check that we are being passed a good pointer to a valid
@@ -231,7 +577,7 @@ EMSCRIPTEN_RESULT emscripten_fetch_close(emscripten_fetch_t* fetch) {
 
   // This fetch is aborted. Call the error handler if the fetch was still in progress and was
   // canceled in flight.
-  if (fetch->readyState != 4 /*DONE*/ && fetch->__attributes.onerror) {
+  if (fetch->readyState != 4 /*DONE*/ && !finished && fetch->__attributes.onerror) {
     fetch->status = (unsigned short)-1;
     strcpy(fetch->statusText, "aborted with emscripten_fetch_close()");
     fetch->__attributes.onerror(fetch);
@@ -244,12 +590,20 @@ EMSCRIPTEN_RESULT emscripten_fetch_close(emscripten_fetch_t* fetch) {
 size_t emscripten_fetch_get_response_headers_length(emscripten_fetch_t *fetch) {
   if (!fetch || fetch->readyState < 2) return 0;
 
+#if __EMSCRIPTEN_PTHREADS__
+  if (fetch->__proxyState)
+    return (size_t)get_proxied_response_headers((int32_t)fetch->id, 0, 0);
+#endif
   return (size_t)_emscripten_fetch_get_response_headers_length((int32_t)fetch->id);
 }
 
 size_t emscripten_fetch_get_response_headers(emscripten_fetch_t *fetch, char *dst, size_t dstSizeBytes) {
   if (!fetch || fetch->readyState < 2) return 0;
 
+#if __EMSCRIPTEN_PTHREADS__
+  if (fetch->__proxyState)
+    return (size_t)get_proxied_response_headers((int32_t)fetch->id, (int32_t)dst, (int32_t)dstSizeBytes);
+#endif
   return (size_t)_emscripten_fetch_get_response_headers((int32_t)fetch->id, (int32_t)dst, (int32_t)dstSizeBytes);
 }
 
@@ -303,7 +657,17 @@ void emscripten_fetch_free(unsigned int id) {
 }
 
 static void fetch_free(emscripten_fetch_t* fetch) {
-  emscripten_fetch_free(fetch->id);
+#if __EMSCRIPTEN_PTHREADS__
+  if (fetch->__proxyState)
+    emscripten_dispatch_to_thread_async(fetch_thread, EM_FUNC_SIG_VI, free_on_fetch_thread, 0, fetch->id);
+  else
+#endif
+    emscripten_fetch_free(fetch->id);
+  fetch_free_memory(fetch);
+}
+
+// Frees what emscripten_fetch_t holds on the C side.
+static void fetch_free_memory(emscripten_fetch_t* fetch) {
   fetch->id = 0;
   free((void*)fetch->data);
   free((void*)fetch->url);
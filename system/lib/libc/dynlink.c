@@ -23,6 +23,7 @@
 
 extern void* _dlopen_js(struct dso* handle);
 extern void* _dlsym_js(struct dso* handle, const char* symbol);
+extern void _dlclose_js(struct dso* handle);
 extern void _emscripten_dlopen_js(struct dso* handle,
                                   em_arg_callback_func onsuccess,
                                   em_arg_callback_func onerror);
@@ -88,6 +89,7 @@ static void dlopen_js_onsuccess(void* handle) {
   fprintf(stderr, "%p: dlopen_js_onsuccess: dso=%p mem_addr=%p mem_size=%p\n", pthread_self(), p, p->mem_addr, p->mem_size);
 #endif
   load_library_done(p);
+  p->refcount = 1;
   pthread_rwlock_unlock(&lock);
   p->onsuccess(p->user_data, p);
 }
@@ -142,6 +144,7 @@ void* dlopen(const char* file, int flags) {
 #ifdef DYLINK_DEBUG
       fprintf(stderr, "%p: dlopen: already opened: %p\n", pthread_self(), p);
 #endif
+      p->refcount++;
       goto end;
     }
   }
@@ -162,6 +165,7 @@ void* dlopen(const char* file, int flags) {
 #ifdef DYLINK_DEBUG
   fprintf(stderr, "%p: dlopen_js: success: %p\n", pthread_self(), p);
 #endif
+  p->refcount = 1;
   load_library_done(p);
 end:
   pthread_rwlock_unlock(&lock);
@@ -193,6 +197,39 @@ void emscripten_dlopen(const char* filename, int flags, void* user_data,
   _emscripten_dlopen_js(p, dlopen_js_onsuccess, dlopen_js_onerror);
 }
 
+// Returns whether another handle for the library called name is still open.
+static int is_open(const char* name) {
+  for (struct dso* p = head; p; p = p->next) {
+    if (p->refcount > 0 && !strcmp(p->name, name)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int dlclose(void* handle) {
+  ensure_init();
+  struct dso* p = handle;
+  pthread_rwlock_wrlock(&lock);
+  if (__dl_invalid_handle(p)) {
+    pthread_rwlock_unlock(&lock);
+    return 1;
+  }
+  // Wasm code can't be unloaded, so the library stays in place, but once
+  // nothing has it open its compiled module no longer needs to be kept for
+  // loading it on new threads.
+  int release = p != head && !(p->flags & RTLD_NODELETE) && p->refcount > 0 &&
+                --p->refcount == 0 && !is_open(p->name);
+  pthread_rwlock_unlock(&lock);
+  if (release) {
+#ifdef DYLINK_DEBUG
+    fprintf(stderr, "%p: dlclose: releasing %s\n", pthread_self(), p->name);
+#endif
+    _dlclose_js(p);
+  }
+  return 0;
+}
+
 void* __dlsym(void* restrict p, const char* restrict s, void* restrict ra) {
 #ifdef DYLINK_DEBUG
   fprintf(stderr, "%p: __dlsym dso:%p sym:%s\n", pthread_self(), p, s);
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <emscripten.h>
+
+// Implemented in JS.  When running under emcc at link time with HEAP_SNAPSHOT
+// this writes out the contents of memory and exits; otherwise it does nothing.
+void _emscripten_take_heap_snapshot(void);
+
+// Only ever set while the snapshot is being taken, so that it reads as 1 in a
+// program started from the snapshot.
+static int snapshot_restored;
+
+void emscripten_snapshot_point(void) {
+  if (snapshot_restored) {
+    return;
+  }
+  // Output still sitting in stdio buffers would otherwise be written a second
+  // time by every run started from the snapshot.
+  fflush(NULL);
+  snapshot_restored = 1;
+  _emscripten_take_heap_snapshot();
+  snapshot_restored = 0;
+}
+
+int emscripten_snapshot_restored(void) {
+  return snapshot_restored;
+}
@@ -33,6 +33,9 @@ struct dso {
   void* table_addr;
   size_t table_size;
 
+  // Number of dlopen() calls not yet matched by dlclose().
+  int refcount;
+
   // Flexible array; must be final element of struct
   char name[];
 };
@@ -20,6 +20,8 @@
 
 #ifdef __EMSCRIPTEN__
 #define EM_THREAD_NAME_MAX 32
+#define EM_THREAD_PROFILER_MAX_FUTEXES 8
+#define EM_THREAD_PROFILER_MAX_PROXIED_CALLS 8
 
 typedef struct thread_profiler_block {
 	// One of THREAD_STATUS_*
@@ -31,6 +33,17 @@ typedef struct thread_profiler_block {
 	double timeSpentInStatus[EM_THREAD_STATUS_NUMFIELDS];
 	// A human-readable name for this thread.
 	char name[EM_THREAD_NAME_MAX];
+	// The futex addresses this thread has spent the most time blocked on, with
+	// the total time in msecs and the number of waits for each. Only written by
+	// the thread itself.
+	double futexWaitTime[EM_THREAD_PROFILER_MAX_FUTEXES];
+	void* futexAddress[EM_THREAD_PROFILER_MAX_FUTEXES];
+	uint32_t futexWaitCount[EM_THREAD_PROFILER_MAX_FUTEXES];
+	// The longest waits of this thread for a call it proxied to another thread,
+	// in msecs, and the functionEnum and functionPtr of each call.
+	double proxiedCallLatency[EM_THREAD_PROFILER_MAX_PROXIED_CALLS];
+	int proxiedCallSignature[EM_THREAD_PROFILER_MAX_PROXIED_CALLS];
+	void* proxiedCallFunction[EM_THREAD_PROFILER_MAX_PROXIED_CALLS];
 } thread_profiler_block;
 #endif
 
@@ -199,6 +212,13 @@ hidden void __unmapself(void *, size_t);
 hidden int __timedwait(volatile int *, int, clockid_t, const struct timespec *, int);
 hidden int __timedwait_cp(volatile int *, int, clockid_t, const struct timespec *, int);
 hidden void __wait(volatile int *, volatile int *, int, int);
+#ifdef __EMSCRIPTEN__
+// Parking a thread means calling out to JS for Atomics.wait, and waking it an
+// Atomics.notify, which together take several microseconds - far longer than
+// most critical sections. So before parking, spin for roughly that long,
+// checking in rounds that double in length, i.e. 2^__EM_SPIN_ROUNDS-1 reads.
+#define __EM_SPIN_ROUNDS 12
+#endif
 static inline void __wake(volatile void *addr, int cnt, int priv)
 {
 	if (priv) priv = FUTEX_PRIVATE;
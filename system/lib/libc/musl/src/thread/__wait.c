@@ -11,7 +11,11 @@ int _pthread_isduecanceled(struct pthread *pthread_ptr);
 
 void __wait(volatile int *addr, volatile int *waiters, int val, int priv)
 {
+#ifdef __EMSCRIPTEN__
+	int spins=(1<<__EM_SPIN_ROUNDS)-1;
+#else
 	int spins=100;
+#endif
 	if (priv) priv = FUTEX_PRIVATE;
 	while (spins-- && (!waiters || !*waiters)) {
 		if (*addr==val) a_spin();
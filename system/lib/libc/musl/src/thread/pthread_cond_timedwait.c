@@ -49,13 +49,11 @@ static inline void unlock_requeue(volatile int *l, volatile int *r, int w)
 {
 	a_store(l, 0);
 #ifdef __EMSCRIPTEN__
-	// Here the intent is to wake one waiter, and requeue all other waiters from waiting on address 'l'
-	// to wait on address 'r' instead. This is not possible at the moment with SharedArrayBuffer Atomics,
-	// as it does not have a "wake X waiters and requeue the rest" primitive. However this kind of
-	// primitive is strictly not needed, since it is more like an optimization to avoid spuriously waking
-	// all waiters, just to make them wait on another location immediately afterwards. Here we do exactly
-	// that: wake every waiter.
-	emscripten_futex_wake(l, 0x7FFFFFFF);
+	// Here the intent is to requeue the waiter on address 'l' to wait on the mutex 'r' instead, which
+	// SharedArrayBuffer Atomics have no primitive for, so wake it. Only the thread that owns a barrier
+	// ever waits on it, so this wakes a single thread, and that thread then spins on the mutex for a
+	// while in pthread_mutex_lock before parking on it.
+	__wake(l, 1, 1);
 #else
 	if (w) __wake(l, 1, 1);
 	else __syscall(SYS_futex, l, FUTEX_REQUEUE|FUTEX_PRIVATE, 0, 1, r) != -ENOSYS
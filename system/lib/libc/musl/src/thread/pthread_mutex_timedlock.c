@@ -71,8 +71,20 @@ int __pthread_mutex_timedlock(pthread_mutex_t *restrict m, const struct timespec
 	if (type&8) return pthread_mutex_timedlock_pi(m, at);
 #endif
 	
+#ifdef __EMSCRIPTEN__
+	// Wait for the lock to be released, and try to take it, backing off
+	// exponentially when another thread gets it first.
+	for (int round = 0; round < __EM_SPIN_ROUNDS && !m->_m_waiters; round++) {
+		for (int i = 1 << round; i && m->_m_lock; i--) a_spin();
+		if (!m->_m_lock) {
+			r = __pthread_mutex_trylock(m);
+			if (r != EBUSY) return r;
+		}
+	}
+#else
 	int spins = 100;
 	while (spins-- && m->_m_lock && !m->_m_waiters) a_spin();
+#endif
 
 	while ((r=__pthread_mutex_trylock(m)) == EBUSY) {
 		r = m->_m_lock;
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Work-stealing scheduler, see emscripten/scheduler.h.
+//
+// Each thread's deque is a fixed size Chase-Lev deque ("Correct and Efficient
+// Work-Stealing for Weak Memory Models", Lê et al. 2013): the owner pushes and
+// takes at the bottom, and thieves take from the top. When a deque is full,
+// new tasks simply run immediately.
+//
+// Idle workers park on wake_epoch. A worker registers in num_sleeping and then
+// checks every deque once more before waiting, while a thread that pushes a
+// task checks num_sleeping afterwards and bumps the epoch if anyone is parked,
+// so a task is never left queued with every worker asleep.
+//
+// Threads waiting for a task group park on group_epoch in the same way, rather
+// than on the group itself. Groups often live on the waiter's stack, and the
+// thread that finishes the last task must not touch the group once the waiter
+// can see it is done and return.
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <emscripten/scheduler.h>
+#include <emscripten/threading.h>
+
+#define DEQUE_CAPACITY 4096 // Must be a power of two.
+#define SPINS_BEFORE_PARKING 64
+
+typedef struct task {
+  em_task_func func;
+  void* arg;
+  em_task_group* group;
+} task;
+
+// Thieves can read a slot while the owner overwrites it. The value they read
+// is then discarded, as they fail to claim it, but the accesses still need to
+// be atomic.
+typedef struct task_slot {
+  _Atomic(em_task_func) func;
+  _Atomic(void*) arg;
+  _Atomic(em_task_group*) group;
+} task_slot;
+
+typedef struct worker {
+  _Atomic int64_t top;
+  // Keep the ends that thieves and the owner write on separate cache lines.
+  char padding[64 - sizeof(int64_t)];
+  _Atomic int64_t bottom;
+  uint32_t rng;
+  pthread_t thread;
+  task_slot slots[DEQUE_CAPACITY];
+} worker;
+
+// workers[0] belongs to the main runtime thread, and the rest to the worker
+// threads.
+static worker* workers;
+static int num_workers;
+static _Atomic bool stopping;
+static _Atomic uint32_t wake_epoch;
+static _Atomic int num_sleeping;
+static _Atomic uint32_t group_epoch;
+static _Atomic int num_group_waiters;
+static _Thread_local worker* current_worker;
+
+#define PENDING(group) ((_Atomic int*)&(group)->pending)
+
+static bool push(worker* w, const task* t) {
+  int64_t b = atomic_load_explicit(&w->bottom, memory_order_relaxed);
+  int64_t top = atomic_load_explicit(&w->top, memory_order_acquire);
+  if (b - top >= DEQUE_CAPACITY) {
+    return false;
+  }
+  task_slot* slot = &w->slots[b & (DEQUE_CAPACITY - 1)];
+  atomic_store_explicit(&slot->func, t->func, memory_order_relaxed);
+  atomic_store_explicit(&slot->arg, t->arg, memory_order_relaxed);
+  atomic_store_explicit(&slot->group, t->group, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+  return true;
+}
+
+static void read_slot(worker* w, int64_t i, task* t) {
+  task_slot* slot = &w->slots[i & (DEQUE_CAPACITY - 1)];
+  t->func = atomic_load_explicit(&slot->func, memory_order_relaxed);
+  t->arg = atomic_load_explicit(&slot->arg, memory_order_relaxed);
+  t->group = atomic_load_explicit(&slot->group, memory_order_relaxed);
+}
+
+// Takes the newest task from the calling thread's own deque.
+static bool take(worker* w, task* t) {
+  int64_t b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t top = atomic_load_explicit(&w->top, memory_order_relaxed);
+  if (top > b) {
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    return false;
+  }
+  read_slot(w, b, t);
+  if (top == b) {
+    // This is the last task, so race thieves for it.
+    bool won = atomic_compare_exchange_strong_explicit(
+      &w->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+// Takes the oldest task from another thread's deque.
+static bool steal(worker* w, task* t) {
+  int64_t top = atomic_load_explicit(&w->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+  if (top >= b) {
+    return false;
+  }
+  read_slot(w, top, t);
+  return atomic_compare_exchange_strong_explicit(
+    &w->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+static bool find_task(worker* self, task* t) {
+  if (take(self, t)) {
+    return true;
+  }
+  // Start stealing at a random deque, so that thieves spread out.
+  uint32_t x = self->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  self->rng = x;
+  int count = num_workers + 1;
+  int start = x % count;
+  for (int i = 0; i < count; i++) {
+    worker* victim = &workers[(start + i) % count];
+    if (victim != self && steal(victim, t)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool any_queued(void) {
+  for (int i = 0; i <= num_workers; i++) {
+    if (atomic_load(&workers[i].top) < atomic_load(&workers[i].bottom)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void run_task(const task* t) {
+  t->func(t->arg);
+  if (atomic_fetch_sub(PENDING(t->group), 1) != 1) {
+    return;
+  }
+  // The group may be gone as soon as the count reaches zero, so only the
+  // global wake word is used from here on.
+  atomic_fetch_add(&group_epoch, 1);
+  if (atomic_load(&num_group_waiters)) {
+    emscripten_futex_wake(&group_epoch, INT_MAX);
+  }
+}
+
+static void wake_one(void) {
+  // Pairs with the increment of num_sleeping in worker_main, see the comment at
+  // the top of the file.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&num_sleeping, memory_order_relaxed)) {
+    atomic_fetch_add(&wake_epoch, 1);
+    emscripten_futex_wake(&wake_epoch, 1);
+  }
+}
+
+static void* worker_main(void* arg) {
+  worker* self = arg;
+  current_worker = self;
+  int idle_spins = 0;
+  while (!atomic_load(&stopping)) {
+    task t;
+    if (find_task(self, &t)) {
+      run_task(&t);
+      idle_spins = 0;
+      continue;
+    }
+    if (++idle_spins < SPINS_BEFORE_PARKING) {
+      continue;
+    }
+    uint32_t epoch = atomic_load(&wake_epoch);
+    atomic_fetch_add(&num_sleeping, 1);
+    if (!any_queued() && !atomic_load(&stopping)) {
+      emscripten_futex_wait(&wake_epoch, epoch, INFINITY);
+    }
+    atomic_fetch_sub(&num_sleeping, 1);
+    idle_spins = 0;
+  }
+  return NULL;
+}
+
+int emscripten_scheduler_init(int requested) {
+  assert(emscripten_is_main_runtime_thread());
+  assert(!workers && "scheduler is already running");
+  if (requested < 0) {
+    requested = emscripten_num_logical_cores() - 1;
+  }
+  workers = calloc(requested + 1, sizeof(worker));
+  if (!workers) {
+    return 0;
+  }
+  for (int i = 0; i <= requested; i++) {
+    workers[i].rng = 2654435761u * (i + 1);
+  }
+  atomic_store(&stopping, false);
+  num_workers = 0;
+  for (int i = 1; i <= requested; i++) {
+    if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i])) {
+      break;
+    }
+    num_workers++;
+  }
+  current_worker = &workers[0];
+  return num_workers;
+}
+
+void emscripten_scheduler_shutdown(void) {
+  assert(emscripten_is_main_runtime_thread());
+  if (!workers) {
+    return;
+  }
+  assert(!any_queued() && "all task groups must be waited for before shutdown");
+  atomic_store(&stopping, true);
+  atomic_fetch_add(&wake_epoch, 1);
+  emscripten_futex_wake(&wake_epoch, INT_MAX);
+  for (int i = 1; i <= num_workers; i++) {
+    pthread_join(workers[i].thread, NULL);
+  }
+  current_worker = NULL;
+  free(workers);
+  workers = NULL;
+  num_workers = 0;
+}
+
+int emscripten_scheduler_num_workers(void) {
+  return num_workers;
+}
+
+void emscripten_task_group_run(em_task_group* group, em_task_func func, void* arg) {
+  task t = { func, arg, group };
+  atomic_fetch_add(PENDING(group), 1);
+  worker* self = current_worker;
+  if (self && num_workers && push(self, &t)) {
+    wake_one();
+    return;
+  }
+  run_task(&t);
+}
+
+void emscripten_task_group_wait(em_task_group* group) {
+  worker* self = current_worker;
+  while (atomic_load(PENDING(group)) != 0) {
+    task t;
+    if (self && find_task(self, &t)) {
+      run_task(&t);
+      continue;
+    }
+    // Nothing left to help with, so the group's remaining tasks are running on
+    // other threads. The last one to finish bumps the epoch after its
+    // decrement, so if the count is still non-zero after reading the epoch,
+    // the wait returns once the count reaches zero.
+    atomic_fetch_add(&num_group_waiters, 1);
+    uint32_t epoch = atomic_load(&group_epoch);
+    if (atomic_load(PENDING(group)) != 0) {
+      emscripten_futex_wait(&group_epoch, epoch, INFINITY);
+    }
+    atomic_fetch_sub(&num_group_waiters, 1);
+  }
+}
+
+typedef struct parallel_for_state {
+  _Atomic size_t next;
+  size_t end;
+  size_t grain;
+  em_parallel_for_func func;
+  void* arg;
+} parallel_for_state;
+
+static void run_chunks(void* arg) {
+  parallel_for_state* s = arg;
+  while (1) {
+    size_t begin = atomic_fetch_add(&s->next, s->grain);
+    if (begin >= s->end) {
+      break;
+    }
+    size_t end = s->end - begin > s->grain ? begin + s->grain : s->end;
+    s->func(begin, end, s->arg);
+  }
+}
+
+void emscripten_parallel_for(size_t begin, size_t end, size_t grain, em_parallel_for_func func, void* arg) {
+  if (begin >= end) {
+    return;
+  }
+  if (!grain) {
+    grain = 1;
+  }
+  // Rather than splitting the range up front, queue one task per worker that
+  // claims chunks from a shared counter until the range is exhausted, which
+  // balances uneven chunks without allocating anything.
+  parallel_for_state s = { begin, end, grain, func, arg };
+  size_t helpers = (end - begin - 1) / grain;
+  if (helpers > (size_t)num_workers) {
+    helpers = num_workers;
+  }
+  em_task_group group = EM_TASK_GROUP_INIT;
+  for (size_t i = 0; i < helpers; i++) {
+    emscripten_task_group_run(&group, run_chunks, &s);
+  }
+  run_chunks(&s);
+  emscripten_task_group_wait(&group);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Events for html5 callbacks that run on a pthread are written by JS on the
+// main browser thread directly into a ring in shared memory, one per target
+// thread, rather than each being malloc'd and sent as a separate queued call.
+// A single queued call is sent to drain the ring when it goes from empty to
+// non-empty, and handles every event that has arrived by then.  JS can also
+// coalesce a new event into the last one in the ring (e.g. consecutive
+// mousemoves) if the thread has not started handling it yet.
+//
+// JSEvents.beginEventOnThread/endEventOnThread in library_html5.js write to the
+// ring, using the layout in html5_event_ring.h.
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <emscripten/threading.h>
+
+#include "html5_event_ring.h"
+
+_Static_assert(sizeof(EmscriptenKeyboardEvent) <= EM_HTML5_EVENT_DATA_SIZE, "event does not fit in an event ring entry");
+_Static_assert(sizeof(EmscriptenMouseEvent) <= EM_HTML5_EVENT_DATA_SIZE, "event does not fit in an event ring entry");
+_Static_assert(sizeof(EmscriptenWheelEvent) <= EM_HTML5_EVENT_DATA_SIZE, "event does not fit in an event ring entry");
+_Static_assert(sizeof(EmscriptenUiEvent) <= EM_HTML5_EVENT_DATA_SIZE, "event does not fit in an event ring entry");
+
+static void drain_event_ring(html5_event_ring* ring) {
+  // Clear the flag before reading the head, so that any event published after
+  // that point queues another drain.
+  emscripten_atomic_store_u32(&ring->drain_queued, 0);
+  uint32_t head = emscripten_atomic_load_u32(&ring->head);
+  for (uint32_t i = ring->tail; i != head; i++) {
+    html5_event_ring_entry* entry = &ring->entries[i & (EM_HTML5_EVENT_RING_CAPACITY - 1)];
+    // JS only holds an entry for as long as it takes to coalesce an event into
+    // it.
+    while (emscripten_atomic_cas_u32(&entry->state, EM_HTML5_EVENT_ENTRY_READY, EM_HTML5_EVENT_ENTRY_TAKEN) != EM_HTML5_EVENT_ENTRY_READY) {
+    }
+    entry->callback(entry->eventType, entry->data, entry->userData);
+    emscripten_atomic_store_u32(&ring->tail, i + 1);
+  }
+}
+
+void* _emscripten_html5_event_ring_create(pthread_t thread) {
+  html5_event_ring* ring = (html5_event_ring*)calloc(1, sizeof(html5_event_ring));
+  if (ring) {
+    ring->thread = thread;
+  }
+  return ring;
+}
+
+void _emscripten_html5_event_ring_queue_drain(html5_event_ring* ring) {
+  _emscripten_call_on_thread(0, ring->thread, EM_FUNC_SIG_VI, drain_event_ring, NULL, ring);
+}
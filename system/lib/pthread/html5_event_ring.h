@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Layout of the per-thread html5 event rings (see html5_event_ring.c).  JS
+// reads it through C_STRUCTS.html5_event_ring, C_STRUCTS.html5_event_ring_entry
+// and the EM_HTML5_EVENT_* defines in src/struct_info_internal.json.
+
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <emscripten/html5.h>
+
+#define EM_HTML5_EVENT_RING_CAPACITY 64 // Must be a power of two.
+#define EM_HTML5_EVENT_DATA_SIZE 192
+
+// Entry states.  An entry is FREE or TAKEN while JS fills it for the first
+// time, which it does before publishing it by advancing the head.  After that,
+// JS only rewrites it (to coalesce) after moving it from READY to WRITING, so
+// the thread must move it from READY to TAKEN before reading it.
+#define EM_HTML5_EVENT_ENTRY_FREE 0
+#define EM_HTML5_EVENT_ENTRY_READY 1
+#define EM_HTML5_EVENT_ENTRY_WRITING 2
+#define EM_HTML5_EVENT_ENTRY_TAKEN 3
+
+typedef EM_BOOL (*html5_event_callback)(int eventType, const void* event, void* userData);
+
+typedef struct html5_event_ring_entry {
+  uint32_t state;
+  int eventType;
+  html5_event_callback callback;
+  void* userData;
+  double data[EM_HTML5_EVENT_DATA_SIZE / sizeof(double)];
+} html5_event_ring_entry;
+
+typedef struct html5_event_ring {
+  uint32_t head; // Only written by JS.
+  uint32_t tail; // Only written by the target thread.
+  uint32_t drain_queued;
+  pthread_t thread;
+  html5_event_ring_entry entries[EM_HTML5_EVENT_RING_CAPACITY];
+} html5_event_ring;
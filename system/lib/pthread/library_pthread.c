@@ -81,6 +81,10 @@ int pthread_mutexattr_setprioceiling(pthread_mutexattr_t *attr, int prioceiling)
 
 static uint32_t dummyZeroAddress = 0;
 
+// Implemented in JavaScript. True if futex waits on the main thread return to
+// the event loop instead of busy-waiting (see MAIN_THREAD_ASYNC_WAITS).
+extern int _emscripten_main_thread_waits_async(void);
+
 void emscripten_thread_sleep(double msecs) {
   double now = emscripten_get_now();
   double target = now + msecs;
@@ -92,8 +96,10 @@ void emscripten_thread_sleep(double msecs) {
   // If we have less than this many msecs left to wait, busy spin that instead.
   const double minimumTimeSliceToSleep = 0.1;
 
-  // runtime thread may need to run proxied calls, so sleep in very small slices to be responsive.
-  const double maxMsecsSliceToSleep = emscripten_is_main_runtime_thread() ? 1 : 100;
+  // runtime thread may need to run proxied calls, so sleep in very small slices to be responsive,
+  // unless its waits return to the event loop, which then runs proxied calls for us.
+  const double maxMsecsSliceToSleep =
+    emscripten_is_main_runtime_thread() && !_emscripten_main_thread_waits_async() ? 1 : 100;
 
   emscripten_conditional_set_current_thread_status(
     EM_THREAD_STATUS_RUNNING, EM_THREAD_STATUS_SLEEPING);
@@ -341,12 +347,33 @@ static CallQueue* GetOrAllocateQueue(void* target) {
   return q;
 }
 
+// Records how long the calling thread waited for a proxied call, if it is
+// among the longest waits so far. Only has an effect with --threadprofiler.
+static void record_proxied_call_latency(em_queued_call* call, double latency) {
+  thread_profiler_block* block = __pthread_self()->profilerBlock;
+  if (!block) {
+    return;
+  }
+  int shortest = 0;
+  for (int i = 1; i < EM_THREAD_PROFILER_MAX_PROXIED_CALLS; i++) {
+    if (block->proxiedCallLatency[i] < block->proxiedCallLatency[shortest]) {
+      shortest = i;
+    }
+  }
+  if (latency > block->proxiedCallLatency[shortest]) {
+    block->proxiedCallLatency[shortest] = latency;
+    block->proxiedCallSignature[shortest] = call->functionEnum;
+    block->proxiedCallFunction[shortest] = call->functionPtr;
+  }
+}
+
 EMSCRIPTEN_RESULT emscripten_wait_for_call_v(em_queued_call* call, double timeoutMSecs) {
   int r;
 
   int done = atomic_load(&call->operationDone);
   if (!done) {
     double now = emscripten_get_now();
+    double waitStartTime = now;
     double waitEndTime = now + timeoutMSecs;
     emscripten_set_current_thread_status(EM_THREAD_STATUS_WAITPROXY);
     while (!done && now < waitEndTime) {
@@ -355,6 +382,7 @@ EMSCRIPTEN_RESULT emscripten_wait_for_call_v(em_queued_call* call, double timeou
       now = emscripten_get_now();
     }
     emscripten_set_current_thread_status(EM_THREAD_STATUS_RUNNING);
+    record_proxied_call_latency(call, now - waitStartTime);
   }
   if (done)
     return EMSCRIPTEN_RESULT_SUCCESS;
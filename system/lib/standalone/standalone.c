@@ -11,6 +11,7 @@
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/mman.h>
 
 #include <emscripten.h>
 #include <emscripten/heap.h>
@@ -51,19 +52,94 @@ int clock_getres(clockid_t clk_id, struct timespec *tp) {
   return 0;
 }
 
-// mmap support is nonexistent. TODO: emulate simple mmaps using
-// stdio + malloc, which is slow but may help some things?
+// mmap: anonymous mappings, and file mappings that are read-only or private,
+// are emulated with malloc.  File contents are read in with fd_pread, which a
+// host can implement by mapping the file into linear memory rather than
+// copying it (the wasm2c runtime does so in guard page mode), so mappings are
+// aligned to wasm pages to give it whole host pages to work with.
+
+#define MMAP_ALIGN 65536
+
+struct mapping {
+  void* addr;
+  size_t length;
+  int file;
+  struct mapping* next;
+};
+
+static struct mapping* mappings;
+
+// Tells the host that a file mapping is going away, so that if fd_pread mapped
+// the file into that memory, it can put ordinary memory back before malloc
+// reuses it.
+extern void _emscripten_notify_munmap(void* addr, size_t length);
 
 long __map_file(int x, int y) {
   return -ENOSYS;
 }
 
-long __syscall_munmap(int x, int y) {
-  return -ENOSYS;
+long __syscall_munmap(long addr, long len) {
+  for (struct mapping** p = &mappings; *p; p = &(*p)->next) {
+    struct mapping* map = *p;
+    if (map->addr == (void*)addr) {
+      // Only whole mappings can be unmapped.
+      if (map->length != len) {
+        return -EINVAL;
+      }
+      *p = map->next;
+      if (map->file) {
+        _emscripten_notify_munmap(map->addr, map->length);
+      }
+      free(map->addr);
+      free(map);
+      return 0;
+    }
+  }
+  return -EINVAL;
 }
 
 long __syscall_mmap2(long addr, long len, long prot, long flags, long fd, long off) {
-  return -ENOSYS;
+  // Writes through a shared file mapping would need to reach the file, and
+  // fixed mappings would need to replace memory malloc already owns.
+  if ((flags & MAP_FIXED) ||
+      (!(flags & MAP_ANONYMOUS) && (flags & MAP_SHARED) && (prot & PROT_WRITE))) {
+    return -ENOSYS;
+  }
+  if (len == 0) {
+    return -EINVAL;
+  }
+  struct mapping* map = malloc(sizeof(struct mapping));
+  void* ptr;
+  if (!map || posix_memalign(&ptr, MMAP_ALIGN, len) != 0) {
+    free(map);
+    return -ENOMEM;
+  }
+  size_t filled = 0;
+  if (!(flags & MAP_ANONYMOUS)) {
+    __wasi_filesize_t offset = (__wasi_filesize_t)off * 4096;
+    while (filled < len) {
+      __wasi_iovec_t iov = {.buf = (uint8_t*)ptr + filled, .buf_len = len - filled};
+      __wasi_size_t nread;
+      __wasi_errno_t error = __wasi_fd_pread(fd, &iov, 1, offset + filled, &nread);
+      if (error != __WASI_ERRNO_SUCCESS) {
+        free(ptr);
+        free(map);
+        return -error;
+      }
+      if (nread == 0) {
+        break; // end of file
+      }
+      filled += nread;
+    }
+  }
+  // Past the end of the file, a mapping reads as zeros.
+  memset((uint8_t*)ptr + filled, 0, len - filled);
+  map->addr = ptr;
+  map->length = len;
+  map->file = !(flags & MAP_ANONYMOUS);
+  map->next = mappings;
+  mappings = map;
+  return (long)ptr;
 }
 
 // open(), etc. - we just support the standard streams, with no
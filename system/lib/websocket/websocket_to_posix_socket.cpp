@@ -3,6 +3,7 @@
 
 #include <emscripten/emscripten.h>
 #include <emscripten/websocket.h>
+#include <emscripten/posix_socket.h>
 #include <emscripten/threading.h>
 #include <pthread.h>
 #include <sys/socket.h>
@@ -51,10 +52,14 @@ struct SocketCallResultHeader
 
 struct PosixSocketCallResult
 {
-  PosixSocketCallResult *next;
   int callId;
   _Atomic uint32_t operationCompleted;
 
+  // If nonzero, no thread is waiting for this result: it is freed as soon as it arrives, and if it reports
+  // an error, that error is deferred to the next send on 'socket'. (used for pipelined sends)
+  int detached;
+  int socket;
+
   // Before the call has finished, this field represents the minimum expected number of bytes that server will need to report back.
   // After the call has finished, this field reports back the number of bytes pointed to by data, >= the expected value.
   int bytes;
@@ -63,18 +68,32 @@ struct PosixSocketCallResult
   SocketCallResultHeader *data;
 };
 
-// Shield multithreaded accesses to POSIX sockets functions in the program, namely the two variables 'bridgeSocket' and 'callResultHead' below.
+// Shield multithreaded accesses to POSIX sockets functions in the program, namely the variables 'bridgeSocket', 'callResultTable' and
+// 'deferredSendError*' below.
 static pthread_mutex_t bridgeLock = PTHREAD_MUTEX_INITIALIZER;
 
 // Socket handle for the connection from browser WebSocket to the sockets bridge proxy server.
 static EMSCRIPTEN_WEBSOCKET_T bridgeSocket = (EMSCRIPTEN_WEBSOCKET_T)0;
 
-// Stores a linked list of all currently pending sockets operations (ones that are waiting for a reply back from the sockets proxy server)
-static PosixSocketCallResult *callResultHead = 0;
+// Stores all currently pending sockets operations (ones that are waiting for a reply back from the sockets proxy server), indexed
+// by the low bits of their call ID, so that matching up a reply with its call is O(1). Call IDs are handed out so that no two
+// pending calls map to the same slot.
+#define MAX_PENDING_CALLS 1024 // Must be a power of two
+static PosixSocketCallResult *callResultTable[MAX_PENDING_CALLS] = {};
+
+// If nonzero, send()/sendto()/sendmsg() return as soon as the message has been posted to the bridge, without waiting for the
+// result of the call. See emscripten_websocket_to_posix_socket_bridge_set_pipelined_sends().
+static _Atomic uint32_t pipelinedSends = 0;
 
+// The first error that a pipelined send failed with, to be reported back on the next send on the same socket.
+static int deferredSendErrorSocket = -1;
+static int deferredSendErrno = 0;
+
+// Returns 0 if out of memory, or if MAX_PENDING_CALLS calls are already pending (e.g. after many pipelined sends), in
+// which case callers fail with ENOBUFS.
 static PosixSocketCallResult *allocate_call_result(int expectedBytes)
 {
-  pthread_mutex_lock(&bridgeLock); // Guard multithreaded access to 'callResultHead' and 'nextId' below
+  pthread_mutex_lock(&bridgeLock); // Guard multithreaded access to 'callResultTable' and 'nextId' below
   PosixSocketCallResult *b = (PosixSocketCallResult*)(malloc(sizeof(PosixSocketCallResult)));
   if (!b)
   {
@@ -85,24 +104,46 @@ static PosixSocketCallResult *allocate_call_result(int expectedBytes)
     return 0;
   }
   static int nextId = 1;
-  b->callId = nextId++;
+  int tries = 0;
+  while(callResultTable[nextId & (MAX_PENDING_CALLS-1)])
+  {
+    if (++tries == MAX_PENDING_CALLS)
+    {
+#ifdef POSIX_SOCKET_DEBUG
+      emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "allocate_call_result: Too many pending sockets calls (%d)!\n", MAX_PENDING_CALLS);
+#endif
+      free(b);
+      pthread_mutex_unlock(&bridgeLock);
+      return 0;
+    }
+    nextId = (nextId == 0x7FFFFFFF) ? 1 : nextId + 1;
+  }
+  b->callId = nextId;
+  nextId = (nextId == 0x7FFFFFFF) ? 1 : nextId + 1;
 #ifdef POSIX_SOCKET_DEEP_DEBUG
   emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "allocate_call_result: allocated call ID %d\n", b->callId);
 #endif
   b->bytes = expectedBytes;
   b->data = 0;
   b->operationCompleted = 0;
-  b->next = 0;
+  b->detached = 0;
+  b->socket = -1;
 
-  if (!callResultHead)
-    callResultHead = b;
-  else
+  callResultTable[b->callId & (MAX_PENDING_CALLS-1)] = b;
+  pthread_mutex_unlock(&bridgeLock);
+  return b;
+}
+
+// Allocates a call result for a send that nobody will wait on.
+static PosixSocketCallResult *allocate_detached_call_result(int socket)
+{
+  PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (b)
   {
-    PosixSocketCallResult *t = callResultHead;
-    while(t->next) t = t->next;
-    t->next = b;
+    // Safe to set after the result has been published to the table, since its reply can only arrive after the call message has been sent.
+    b->detached = 1;
+    b->socket = socket;
   }
-  pthread_mutex_unlock(&bridgeLock);
   return b;
 }
 
@@ -119,24 +160,17 @@ static void free_call_result(PosixSocketCallResult *buffer)
 
 PosixSocketCallResult *pop_call_result(int callId)
 {
-  pthread_mutex_lock(&bridgeLock); // Guard multithreaded access to 'callResultHead'
-  PosixSocketCallResult *prev = 0;
-  PosixSocketCallResult *b = callResultHead;
-  while(b)
+  pthread_mutex_lock(&bridgeLock); // Guard multithreaded access to 'callResultTable'
+  PosixSocketCallResult **slot = &callResultTable[callId & (MAX_PENDING_CALLS-1)];
+  PosixSocketCallResult *b = *slot;
+  if (b && b->callId == callId)
   {
-    if (b->callId == callId)
-    {
-      if (prev) prev->next = b->next;
-      else callResultHead = b->next;
-      b->next = 0;
+    *slot = 0;
 #ifdef POSIX_SOCKET_DEEP_DEBUG
-      emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "pop_call_result: Removed call ID %d from pending sockets call queue\n", callId);
+    emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "pop_call_result: Removed call ID %d from pending sockets call queue\n", callId);
 #endif
-      pthread_mutex_unlock(&bridgeLock);
-      return b;
-    }
-    prev = b;
-    b = b->next;
+    pthread_mutex_unlock(&bridgeLock);
+    return b;
   }
   pthread_mutex_unlock(&bridgeLock);
 #ifdef POSIX_SOCKET_DEBUG
@@ -145,6 +179,22 @@ PosixSocketCallResult *pop_call_result(int callId)
   return 0;
 }
 
+// Returns the errno of a previously failed pipelined send on the given socket (clearing it), or 0 if there was none.
+static int take_deferred_send_error(int socket)
+{
+  if (!pipelinedSends) return 0;
+  pthread_mutex_lock(&bridgeLock); // Guard multithreaded access to 'deferredSendError*'
+  int err = 0;
+  if (deferredSendErrorSocket == socket)
+  {
+    err = deferredSendErrno;
+    deferredSendErrorSocket = -1;
+    deferredSendErrno = 0;
+  }
+  pthread_mutex_unlock(&bridgeLock);
+  return err;
+}
+
 void wait_for_call_result(PosixSocketCallResult *b)
 {
 #ifdef POSIX_SOCKET_DEEP_DEBUG
@@ -179,6 +229,25 @@ static EM_BOOL bridge_socket_on_message(int eventType, const EmscriptenWebSocket
     return EM_TRUE;
   }
 
+  if (b->detached)
+  {
+    if (header->ret < 0)
+    {
+#ifdef POSIX_SOCKET_DEBUG
+      emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "Pipelined send on socket %d failed with errno %d\n", b->socket, header->errno_);
+#endif
+      pthread_mutex_lock(&bridgeLock);
+      if (deferredSendErrorSocket == -1)
+      {
+        deferredSendErrorSocket = b->socket;
+        deferredSendErrno = header->errno_;
+      }
+      pthread_mutex_unlock(&bridgeLock);
+    }
+    free_call_result(b);
+    return EM_TRUE;
+  }
+
   if (websocketEvent->numBytes < b->bytes)
   {
     emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "Received corrupt WebSocket result message with size %d, expected at least %d bytes!\n", (int)websocketEvent->numBytes, b->bytes);
@@ -231,6 +300,11 @@ EMSCRIPTEN_WEBSOCKET_T emscripten_init_websocket_to_posix_socket_bridge(const ch
   return bridgeSocket;
 }
 
+void emscripten_websocket_to_posix_socket_bridge_set_pipelined_sends(EM_BOOL enabled)
+{
+  pipelinedSends = enabled ? 1 : 0;
+}
+
 #define POSIX_SOCKET_MSG_SOCKET 1
 #define POSIX_SOCKET_MSG_SOCKETPAIR 2
 #define POSIX_SOCKET_MSG_SHUTDOWN 3
@@ -250,10 +324,36 @@ EMSCRIPTEN_WEBSOCKET_T emscripten_init_websocket_to_posix_socket_bridge(const ch
 #define POSIX_SOCKET_MSG_SETSOCKOPT 17
 #define POSIX_SOCKET_MSG_GETADDRINFO 18
 #define POSIX_SOCKET_MSG_GETNAMEINFO 19
+#define POSIX_SOCKET_MSG_POLL 20
 
 #define MAX_SOCKADDR_SIZE 256
 #define MAX_OPTIONVALUE_SIZE 16
 
+// Outgoing messages up to this size are built on the stack instead of the heap.
+#define MAX_STACK_MESSAGE_SIZE 512
+
+// Posts a send()-like call message to the bridge. In pipelined mode returns 'length' immediately, otherwise waits for
+// the result of the call.
+static ssize_t post_send_call(void *msg, size_t msgSize, PosixSocketCallResult *b, size_t length)
+{
+  // The result of a detached send is freed on the main browser thread as soon as it arrives, which can be before
+  // emscripten_websocket_send_binary() returns, so 'b' must not be accessed after sending it.
+  int detached = b->detached;
+  emscripten_websocket_send_binary(bridgeSocket, msg, msgSize);
+  if (detached) return length;
+
+  wait_for_call_result(b);
+  int ret = b->data->ret;
+  if (ret < 0) errno = b->data->errno_;
+  free_call_result(b);
+  return ret;
+}
+
+static PosixSocketCallResult *allocate_send_call_result(int socket)
+{
+  return pipelinedSends ? allocate_detached_call_result(socket) : allocate_call_result(sizeof(SocketCallResultHeader));
+}
+
 int socket(int domain, int type, int protocol)
 {
 #ifdef POSIX_SOCKET_DEBUG
@@ -268,6 +368,11 @@ int socket(int domain, int type, int protocol)
   } d;
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_SOCKET;
   d.domain = domain;
@@ -301,6 +406,11 @@ int socketpair(int domain, int type, int protocol, int socket_vector[2])
   };
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(Result));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_SOCKETPAIR;
   d.domain = domain;
@@ -337,6 +447,11 @@ int shutdown(int socket, int how)
   } d;
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_SHUTDOWN;
   d.socket = socket;
@@ -366,6 +481,12 @@ int bind(int socket, const struct sockaddr *address, socklen_t address_len)
   Data *d = (Data*)malloc(numBytes);
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    free(d);
+    errno = ENOBUFS;
+    return -1;
+  }
   d->header.callId = b->callId;
   d->header.function = POSIX_SOCKET_MSG_BIND;
   d->socket = socket;
@@ -399,6 +520,12 @@ int connect(int socket, const struct sockaddr *address, socklen_t address_len)
   Data *d = (Data*)malloc(numBytes);
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    free(d);
+    errno = ENOBUFS;
+    return -1;
+  }
   d->header.callId = b->callId;
   d->header.function = POSIX_SOCKET_MSG_CONNECT;
   d->socket = socket;
@@ -429,6 +556,11 @@ int listen(int socket, int backlog)
   } d;
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_LISTEN;
   d.socket = socket;
@@ -455,6 +587,11 @@ int accept(int socket, struct sockaddr *address, socklen_t *address_len)
   } d;
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_ACCEPT;
   d.socket = socket;
@@ -504,6 +641,11 @@ int getsockname(int socket, struct sockaddr *address, socklen_t *address_len)
   };
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(Result));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_GETSOCKNAME;
   d.socket = socket;
@@ -547,6 +689,11 @@ int getpeername(int socket, struct sockaddr *address, socklen_t *address_len)
   };
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(Result));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_GETPEERNAME;
   d.socket = socket;
@@ -584,10 +731,24 @@ ssize_t send(int socket, const void *message, size_t length, int flags)
     int flags;
     uint8_t message[];
   };
+  int deferredErrno = take_deferred_send_error(socket);
+  if (deferredErrno)
+  {
+    errno = deferredErrno;
+    return -1;
+  }
+
   size_t sz = sizeof(MSG)+length;
-  MSG *d = (MSG*)malloc(sz);
+  uint8_t stackMsg[MAX_STACK_MESSAGE_SIZE];
+  MSG *d = (MSG*)(sz <= sizeof(stackMsg) ? stackMsg : malloc(sz));
 
-  PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  PosixSocketCallResult *b = allocate_send_call_result(socket);
+  if (!b)
+  {
+    if ((uint8_t*)d != stackMsg) free(d);
+    errno = ENOBUFS;
+    return -1;
+  }
   d->header.callId = b->callId;
   d->header.function = POSIX_SOCKET_MSG_SEND;
   d->socket = socket;
@@ -595,14 +756,9 @@ ssize_t send(int socket, const void *message, size_t length, int flags)
   d->flags = flags;
   if (message) memcpy(d->message, message, length);
   else memset(d->message, 0, length);
-  emscripten_websocket_send_binary(bridgeSocket, d, sz);
-
-  wait_for_call_result(b);
-  int ret = b->data->ret;
-  if (ret < 0) errno = b->data->errno_;
-  free_call_result(b);
+  ssize_t ret = post_send_call(d, sz, b, length);
 
-  free(d);
+  if ((uint8_t*)d != stackMsg) free(d);
   return ret;
 }
 
@@ -620,6 +776,11 @@ ssize_t recv(int socket, void *buffer, size_t length, int flags)
   } d;
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_RECV;
   d.socket = socket;
@@ -647,11 +808,16 @@ ssize_t recv(int socket, void *buffer, size_t length, int flags)
   return ret;
 }
 
-ssize_t sendto(int socket, const void *message, size_t length, int flags, const struct sockaddr *dest_addr, socklen_t dest_len)
+// Serializes sendto() and sendmsg() calls, which share the same message layout. The message data is gathered from the
+// given iovecs.
+static ssize_t proxied_sendto(int function, int socket, const struct iovec *iov, int iovcnt, size_t length, int flags, const struct sockaddr *dest_addr, socklen_t dest_len)
 {
-#ifdef POSIX_SOCKET_DEBUG
-  emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "sendto(socket=%d,message=%p,length=%zd,flags=%d,dest_addr=%p,dest_len=%d)\n", socket, message, length, flags, dest_addr, dest_len);
-#endif
+  int deferredErrno = take_deferred_send_error(socket);
+  if (deferredErrno)
+  {
+    errno = deferredErrno;
+    return -1;
+  }
 
   struct MSG {
     SocketCallHeader header;
@@ -662,37 +828,58 @@ ssize_t sendto(int socket, const void *message, size_t length, int flags, const
     uint8_t dest_addr[MAX_SOCKADDR_SIZE];
     uint8_t message[];
   };
+  if (!dest_addr) dest_len = 0;
+  if (dest_len > MAX_SOCKADDR_SIZE)
+  {
+    errno = EINVAL;
+    return -1;
+  }
   size_t sz = sizeof(MSG)+length;
-  MSG *d = (MSG*)malloc(sz);
+  uint8_t stackMsg[MAX_STACK_MESSAGE_SIZE];
+  MSG *d = (MSG*)(sz <= sizeof(stackMsg) ? stackMsg : malloc(sz));
 
-  PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  PosixSocketCallResult *b = allocate_send_call_result(socket);
+  if (!b)
+  {
+    if ((uint8_t*)d != stackMsg) free(d);
+    errno = ENOBUFS;
+    return -1;
+  }
   d->header.callId = b->callId;
-  d->header.function = POSIX_SOCKET_MSG_SENDTO;
+  d->header.function = function;
   d->socket = socket;
   d->length = length;
   d->flags = flags;
   d->dest_len = dest_len;
   memset(d->dest_addr, 0, sizeof(d->dest_addr));
   if (dest_addr) memcpy(d->dest_addr, dest_addr, dest_len);
-  if (message) memcpy(d->message, message, length);
-  else memset(d->message, 0, length);
-  emscripten_websocket_send_binary(bridgeSocket, d, sz);
-
-  wait_for_call_result(b);
-  int ret = b->data->ret;
-  if (ret < 0) errno = b->data->errno_;
-  free_call_result(b);
+  size_t offset = 0;
+  for(int i = 0; i < iovcnt; ++i)
+  {
+    if (iov[i].iov_base) memcpy(d->message + offset, iov[i].iov_base, iov[i].iov_len);
+    else memset(d->message + offset, 0, iov[i].iov_len);
+    offset += iov[i].iov_len;
+  }
+  ssize_t ret = post_send_call(d, sz, b, length);
 
-  free(d);
+  if ((uint8_t*)d != stackMsg) free(d);
   return ret;
 }
 
-ssize_t recvfrom(int socket, void *buffer, size_t length, int flags, struct sockaddr *address, socklen_t *address_len)
+ssize_t sendto(int socket, const void *message, size_t length, int flags, const struct sockaddr *dest_addr, socklen_t dest_len)
 {
 #ifdef POSIX_SOCKET_DEBUG
-  emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "recvfrom(socket=%d,buffer=%p,length=%zd,flags=%d,address=%p,address_len=%p)\n", socket, buffer, length, flags, address, address_len);
+  emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "sendto(socket=%d,message=%p,length=%zd,flags=%d,dest_addr=%p,dest_len=%d)\n", socket, message, length, flags, dest_addr, dest_len);
 #endif
 
+  struct iovec iov = { (void*)message, length };
+  return proxied_sendto(POSIX_SOCKET_MSG_SENDTO, socket, &iov, 1, length, flags, dest_addr, dest_len);
+}
+
+// Serializes recvfrom() and recvmsg() calls, which share the same message layout. The received data is scattered to the
+// given iovecs.
+static ssize_t proxied_recvfrom(int function, int socket, const struct iovec *iov, int iovcnt, size_t length, int flags, struct sockaddr *address, socklen_t *address_len)
+{
   struct {
     SocketCallHeader header;
     int socket;
@@ -702,12 +889,17 @@ ssize_t recvfrom(int socket, void *buffer, size_t length, int flags, struct sock
   } d;
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
-  d.header.function = POSIX_SOCKET_MSG_RECVFROM;
+  d.header.function = function;
   d.socket = socket;
   d.length = length;
   d.flags = flags;
-  d.address_len = *address_len;
+  d.address_len = address_len ? *address_len : 0;
   emscripten_websocket_send_binary(bridgeSocket, &d, sizeof(d));
 
   wait_for_call_result(b);
@@ -721,7 +913,14 @@ ssize_t recvfrom(int socket, void *buffer, size_t length, int flags, struct sock
       uint8_t data_and_address[];
     };
     Result *r = (Result*)b->data;
-    if (buffer) memcpy(buffer, r->data_and_address, MIN(r->data_len, length));
+    size_t dataLen = MIN((size_t)r->data_len, length);
+    size_t offset = 0;
+    for(int i = 0; i < iovcnt && offset < dataLen; ++i)
+    {
+      size_t n = MIN(iov[i].iov_len, dataLen - offset);
+      if (iov[i].iov_base) memcpy(iov[i].iov_base, r->data_and_address + offset, n);
+      offset += n;
+    }
     int copiedAddressLen = MIN((address_len ? *address_len : 0), r->address_len);
     if (address) memcpy(address, r->data_and_address + r->data_len, copiedAddressLen);
     if (address_len) *address_len = r->address_len;
@@ -735,14 +934,34 @@ ssize_t recvfrom(int socket, void *buffer, size_t length, int flags, struct sock
   return ret;
 }
 
+ssize_t recvfrom(int socket, void *buffer, size_t length, int flags, struct sockaddr *address, socklen_t *address_len)
+{
+#ifdef POSIX_SOCKET_DEBUG
+  emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "recvfrom(socket=%d,buffer=%p,length=%zd,flags=%d,address=%p,address_len=%p)\n", socket, buffer, length, flags, address, address_len);
+#endif
+
+  struct iovec iov = { buffer, length };
+  return proxied_recvfrom(POSIX_SOCKET_MSG_RECVFROM, socket, &iov, 1, length, flags, address, address_len);
+}
+
 ssize_t sendmsg(int socket, const struct msghdr *message, int flags)
 {
 #ifdef POSIX_SOCKET_DEBUG
   emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "sendmsg(socket=%d,message=%p,flags=%d)\n", socket, message, flags);
 #endif
 
-  exit(1); // TODO
-  return 0;
+  // Ancillary data is not supported over the bridge.
+  if (message->msg_controllen)
+  {
+    errno = EOPNOTSUPP;
+    return -1;
+  }
+
+  size_t length = 0;
+  for(int i = 0; i < message->msg_iovlen; ++i)
+    length += message->msg_iov[i].iov_len;
+
+  return proxied_sendto(POSIX_SOCKET_MSG_SENDMSG, socket, message->msg_iov, message->msg_iovlen, length, flags, (const struct sockaddr*)message->msg_name, message->msg_namelen);
 }
 
 ssize_t recvmsg(int socket, struct msghdr *message, int flags)
@@ -751,8 +970,85 @@ ssize_t recvmsg(int socket, struct msghdr *message, int flags)
   emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "recvmsg(socket=%d,message=%p,flags=%d)\n", socket, message, flags);
 #endif
 
-  exit(1); // TODO
-  return 0;
+  size_t length = 0;
+  for(int i = 0; i < message->msg_iovlen; ++i)
+    length += message->msg_iov[i].iov_len;
+
+  socklen_t address_len = message->msg_name ? message->msg_namelen : 0;
+  ssize_t ret = proxied_recvfrom(POSIX_SOCKET_MSG_RECVMSG, socket, message->msg_iov, message->msg_iovlen, length, flags, (struct sockaddr*)message->msg_name, &address_len);
+  if (ret >= 0)
+  {
+    if (message->msg_name) message->msg_namelen = address_len;
+    // Ancillary data is not supported over the bridge.
+    message->msg_controllen = 0;
+    message->msg_flags = 0;
+  }
+  return ret;
+}
+
+int emscripten_websocket_to_posix_socket_bridge_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+#ifdef POSIX_SOCKET_DEBUG
+  emscripten_log(EM_LOG_NO_PATHS | EM_LOG_CONSOLE | EM_LOG_ERROR | EM_LOG_JS_STACK, "poll(fds=%p,nfds=%u,timeout=%d)\n", fds, (unsigned)nfds, timeout);
+#endif
+
+  struct PollFd {
+    int fd;
+    short events;
+    short revents;
+  };
+
+  struct MSG {
+    SocketCallHeader header;
+    int timeout;
+    uint32_t nfds;
+    PollFd fds[];
+  };
+
+  struct Result {
+    SocketCallResultHeader header;
+    PollFd fds[];
+  };
+
+  size_t sz = sizeof(MSG) + nfds * sizeof(PollFd);
+  uint8_t stackMsg[MAX_STACK_MESSAGE_SIZE];
+  MSG *d = (MSG*)(sz <= sizeof(stackMsg) ? stackMsg : malloc(sz));
+
+  PosixSocketCallResult *b = allocate_call_result(sizeof(Result));
+  if (!b)
+  {
+    if ((uint8_t*)d != stackMsg) free(d);
+    errno = ENOBUFS;
+    return -1;
+  }
+  d->header.callId = b->callId;
+  d->header.function = POSIX_SOCKET_MSG_POLL;
+  d->timeout = timeout;
+  d->nfds = nfds;
+  for(nfds_t i = 0; i < nfds; ++i)
+  {
+    d->fds[i].fd = fds[i].fd;
+    d->fds[i].events = fds[i].events;
+    d->fds[i].revents = 0;
+  }
+  emscripten_websocket_send_binary(bridgeSocket, d, sz);
+  if ((uint8_t*)d != stackMsg) free(d);
+
+  wait_for_call_result(b);
+  int ret = b->data->ret;
+  if (ret >= 0)
+  {
+    Result *r = (Result*)b->data;
+    nfds_t numResults = (b->bytes - sizeof(Result)) / sizeof(PollFd);
+    for(nfds_t i = 0; i < nfds; ++i)
+      fds[i].revents = (i < numResults) ? r->fds[i].revents : 0;
+  }
+  else
+  {
+    errno = b->data->errno_;
+  }
+  free_call_result(b);
+  return ret;
 }
 
 int getsockopt(int socket, int level, int option_name, void *option_value, socklen_t *option_len)
@@ -775,6 +1071,11 @@ int getsockopt(int socket, int level, int option_name, void *option_value, sockl
   };
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(Result));
+  if (!b)
+  {
+    errno = ENOBUFS;
+    return -1;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_GETSOCKOPT;
   d.socket = socket;
@@ -818,6 +1119,12 @@ int setsockopt(int socket, int level, int option_name, const void *option_value,
   MSG *d = (MSG*)malloc(messageSize);
 
   PosixSocketCallResult *b = allocate_call_result(sizeof(SocketCallResultHeader));
+  if (!b)
+  {
+    free(d);
+    errno = ENOBUFS;
+    return -1;
+  }
   d->header.callId = b->callId;
   d->header.function = POSIX_SOCKET_MSG_SETSOCKOPT;
   d->socket = socket;
@@ -874,6 +1181,10 @@ int getaddrinfo(const char *node, const char *service, const struct addrinfo *hi
 
   memset(&d, 0, sizeof(d));
   PosixSocketCallResult *b = allocate_call_result(sizeof(Result));
+  if (!b)
+  {
+    return EAI_MEMORY;
+  }
   d.header.callId = b->callId;
   d.header.function = POSIX_SOCKET_MSG_GETADDRINFO;
   if (node)
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Maps data.dat, which holds FILE_SIZE bytes of 'a' + (i % 26), at a nonzero
+// offset, and checks every byte of the mappings, including the zeros past the
+// end of the file.  Then empties the file and reuses the memory.
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define PAGE 4096
+#define FILE_SIZE (4 * PAGE + 100)
+
+#ifdef HOST_OPEN
+// Standalone builds can only open the standard streams, so open the file with
+// the host's import (see test_mmap_file_offset.js for JS).
+int __sys_open(const char* path, int flags, ...);
+#define open __sys_open
+#endif
+
+static int check(const char* m, size_t len, size_t offset) {
+  for (size_t i = 0; i < len; i++) {
+    size_t pos = offset + i;
+    char c = pos < FILE_SIZE ? 'a' + pos % 26 : 0;
+    if (m[i] != c) {
+      printf("mismatch at %zu: %d != %d\n", pos, m[i], c);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int main() {
+  int fd = open("data.dat", O_RDONLY, 0);
+  assert(fd >= 0);
+
+  // A private mapping that starts a page in and runs past the end of the file.
+  size_t len = 4 * PAGE;
+  char* m = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, PAGE);
+  assert(m != MAP_FAILED);
+  printf("private: %c %c %d %d\n", m[0], m[FILE_SIZE - PAGE - 1], m[FILE_SIZE - PAGE], check(m, len, PAGE));
+  // Writes only change our copy.
+  m[0] = '!';
+  m[2 * PAGE] = '!';
+  printf("written: %c %c\n", m[0], m[2 * PAGE]);
+  munmap(m, len);
+
+  m = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, PAGE);
+  assert(m != MAP_FAILED);
+  printf("private again: %c %c %d\n", m[0], m[2 * PAGE], check(m, len, PAGE));
+  munmap(m, len);
+
+  // A read-only shared mapping of whole pages inside the file.
+  len = 2 * PAGE;
+  m = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 2 * PAGE);
+  assert(m != MAP_FAILED);
+  printf("shared: %c %c %d\n", m[0], m[len - 1], check(m, len, 2 * PAGE));
+  munmap(m, len);
+
+  close(fd);
+
+  // Empty the file and reuse the memory the mappings were in, which must no
+  // longer depend on the file.
+  fd = open("data.dat", O_WRONLY | O_TRUNC, 0);
+  assert(fd >= 0);
+  close(fd);
+  void* p;
+  assert(posix_memalign(&p, 65536, 4 * PAGE) == 0);
+  memset(p, 'x', 4 * PAGE);
+  m = p;
+  printf("reused: %c %c\n", m[0], m[4 * PAGE - 1]);
+  free(p);
+  return 0;
+}
@@ -0,0 +1,8 @@
+mergeInto(LibraryManager.library, {
+  // The wasm2c runtime provides this import to standalone builds, which can
+  // otherwise only open the standard streams; do the same in JS.
+  __sys_open__deps: ['__syscall_open'],
+  __sys_open: function(path, flags, varargs) {
+    return ___syscall_open(path, flags, varargs);
+  },
+});
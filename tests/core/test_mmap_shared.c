@@ -0,0 +1,98 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SIZE 20000
+
+int main() {
+  int fd = open("data.dat", O_RDWR | O_CREAT | O_TRUNC, 0666);
+  assert(fd >= 0);
+  char* data = malloc(SIZE);
+  for (int i = 0; i < SIZE; i++) {
+    data[i] = 'a' + i % 26;
+  }
+  assert(write(fd, data, SIZE) == SIZE);
+
+  char* map = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  assert(map != MAP_FAILED);
+  assert(!memcmp(map, data, SIZE));
+
+  // A second mapping of the same file shares the same bytes.
+  char* map2 = mmap(NULL, SIZE - 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 4096);
+  assert(map2 != MAP_FAILED);
+  assert(map2 == map + 4096);
+
+  // Writes through a mapping are visible to read().
+  map[5000] = '!';
+  char c;
+  assert(pread(fd, &c, 1, 5000) == 1);
+  printf("read after store: %c\n", c);
+
+  // Writes through the file descriptor are visible in the mappings.
+  assert(pwrite(fd, "?", 1, 6000) == 1);
+  printf("load after write: %c %c\n", map[6000], map2[6000 - 4096]);
+
+  // Growing the file within the mapping keeps it in place.
+  assert(ftruncate(fd, SIZE + 100) == 0);
+  assert(map[SIZE + 50] == 0);
+  assert(pwrite(fd, "#", 1, SIZE + 50) == 1);
+  printf("load after grow: %c\n", map[SIZE + 50]);
+
+  // The file can't grow past the heap region it was moved to while it is
+  // mapped, as moving it again would leave the existing mappings behind.
+  assert(mmap(NULL, 100000, PROT_READ, MAP_SHARED, fd, 0) == MAP_FAILED);
+  assert(errno == ENOMEM);
+  assert(pwrite(fd, "x", 1, 100000) == -1);
+  assert(errno == ENOSPC);
+  printf("load after failed grow: %c\n", map[5000]);
+
+  // The mappings outlive the descriptor, and unmapping them keeps the data.
+  close(fd);
+  map[7000] = '@';
+  assert(munmap(map2, SIZE - 4096) == 0);
+  assert(munmap(map, SIZE) == 0);
+
+  fd = open("data.dat", O_RDONLY);
+  struct stat st;
+  assert(fstat(fd, &st) == 0);
+  printf("size: %lld\n", (long long)st.st_size);
+  char buf[SIZE + 100];
+  assert(read(fd, buf, sizeof(buf)) == sizeof(buf));
+  printf("after unmap: %c %c %c %c\n", buf[5000], buf[6000], buf[7000], buf[SIZE + 50]);
+  assert(!memcmp(buf, data, 5000));
+  close(fd);
+
+  // Two mappings of the same part of the file get the same address, and each
+  // is released by its own munmap.
+  fd = open("data.dat", O_RDWR);
+  map = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  assert(map != MAP_FAILED);
+  map2 = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  assert(map2 == map);
+  map[8000] = '%';
+  assert(munmap(map, SIZE) == 0);
+  printf("after first unmap: %c\n", map2[8000]);
+  assert(munmap(map2, SIZE) == 0);
+
+  // Once the last of them is gone, the file is free to move to a larger
+  // region.
+  map = mmap(NULL, 100000, PROT_READ, MAP_SHARED, fd, 0);
+  assert(map != MAP_FAILED);
+  printf("larger mapping: %c\n", map[8000]);
+  assert(munmap(map, 100000) == 0);
+  close(fd);
+  return 0;
+}
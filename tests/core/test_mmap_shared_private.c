@@ -0,0 +1,49 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define SIZE 20000
+// Larger than the initial memory, so that making the private mapping has to
+// grow memory.
+#define PRIVATE_SIZE (32 * 1024 * 1024)
+
+int main() {
+  int fd = open("data.dat", O_RDWR | O_CREAT | O_TRUNC, 0666);
+  assert(fd >= 0);
+  char data[SIZE];
+  for (int i = 0; i < SIZE; i++) {
+    data[i] = 'a' + i % 26;
+  }
+  assert(write(fd, data, SIZE) == SIZE);
+
+  char* shared = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  assert(shared != MAP_FAILED);
+  shared[100] = '!';
+
+  // The private copy is made from the shared contents, which live in the heap.
+  char* private = mmap(NULL, PRIVATE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  assert(private != MAP_FAILED);
+  assert(private[100] == '!');
+  assert(!memcmp(private + 200, data + 200, SIZE - 200));
+
+  // Changes to either mapping are not visible in the other one.
+  private[200] = '?';
+  shared[300] = '#';
+  printf("shared: %c %c %c\n", shared[100], shared[200], shared[300]);
+  printf("private: %c %c %c\n", private[100], private[200], private[300]);
+
+  assert(munmap(private, PRIVATE_SIZE) == 0);
+  assert(munmap(shared, SIZE) == 0);
+  close(fd);
+  return 0;
+}
@@ -2472,6 +2472,34 @@ module({
         });
     });
 
+    BaseFixture.extend("many arguments", function() {
+        test("can call function with 8 arguments", function() {
+            assert.equal(36, cm.sum_8_args(1, 2, 3, 4, 5, 6, 7, 8));
+        });
+
+        test("can call function with more than 8 arguments", function() {
+            assert.equal("a 1 2 true e 30 j", cm.join_10_args("a", 1, 2.5, true, "e", 6, 7, 8, 9, "j"));
+            assert.equal(0, cm.count_emval_handles());
+        });
+
+        test("can call method with more than 8 arguments", function() {
+            var m = new cm.ManyArgs;
+            assert.equal(145, m.sum(1, 2, 3, 4, 5, 6, 7, 8, 9));
+            m.delete();
+        });
+
+        test("wrong number of arguments throws", function() {
+            var e = assert.throws(cm.BindingError, function() {
+                cm.sum_8_args(1, 2, 3, 4, 5, 6, 7);
+            });
+            assert.equal('function sum_8_args called with 7 arguments, expected 8 args!', e.message);
+            e = assert.throws(cm.BindingError, function() {
+                cm.join_10_args("a", 1, 2.5, true, "e", 6, 7, 8, 9);
+            });
+            assert.equal('function join_10_args called with 9 arguments, expected 10 args!', e.message);
+        });
+    });
+
     BaseFixture.extend("function names", function() {
         if (!cm['DYNAMIC_EXECUTION']) {
           assert.equal('', cm.ValHolder.name);
@@ -2538,6 +2566,43 @@ module({
         });
     });
 
+    BaseFixture.extend("vectors as typed arrays", function() {
+        test("vector is returned as a typed array copy", function() {
+            var a = cm.returnDoubleVector(4);
+            assert.instanceof(a, Float64Array);
+            assert.deepEqual([0.5, 1.5, 2.5, 3.5], [].slice.call(a));
+            assert.equal(0, cm.returnDoubleVector(0).length);
+        });
+
+        test("vector is returned as a view with return_typed_array_view", function() {
+            var a = cm.returnDoubleVectorView(3);
+            assert.instanceof(a, Float64Array);
+            assert.equal(cm.HEAP8.buffer, a.buffer);
+            assert.deepEqual([0.5, 1.5, 2.5], [].slice.call(a));
+            a.delete();
+        });
+
+        test("can pass typed arrays and arrays as vectors", function() {
+            assert.equal(6, cm.sumShortVector(new Int16Array([1, 2, 3])));
+            assert.equal(6, cm.sumShortVector(new Float64Array([1, 2, 3])));
+            assert.equal(6, cm.sumShortVector([1, 2, 3]));
+            assert.equal(0, cm.sumShortVector([]));
+
+            var a = cm.negateShortVector(new Int16Array([1, -2, 3]));
+            assert.instanceof(a, Int16Array);
+            assert.deepEqual([-1, 2, -3], [].slice.call(a));
+        });
+
+        test("cannot pass non-arrays as vectors", function() {
+            assert.throws(cm.BindingError, function() {
+                cm.sumShortVector(7);
+            });
+            assert.throws(cm.BindingError, function() {
+                cm.sumShortVector(new DataView(new ArrayBuffer(4)));
+            });
+        });
+    });
+
     BaseFixture.extend("delete pool", function() {
         test("can delete objects later", function() {
             var v = new cm.ValHolder({});
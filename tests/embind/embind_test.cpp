@@ -1253,6 +1253,26 @@ void test_string_with_vec(const std::string& p1, std::vector<std::string>& v1) {
     printf("%s\n", p1.c_str());
 }
 
+// Invokers for up to 8 arguments are generated ahead of time; these bind one
+// at that limit and two past it.
+int sum_8_args(int a, int b, int c, int d, int e, int f, int g, int h) {
+    return a + b + c + d + e + f + g + h;
+}
+
+std::string join_10_args(const std::string& a, int b, double c, bool d, const std::string& e,
+                         int f, int g, int h, int i, val j) {
+    return a + " " + std::to_string(b) + " " + std::to_string((int)c) + " " + (d ? "true" : "false") + " " + e + " " +
+        std::to_string(f + g + h + i) + " " + j.as<std::string>();
+}
+
+struct ManyArgs {
+    int sum(int a, int b, int c, int d, int e, int f, int g, int h, int i) const {
+        return base + a + b + c + d + e + f + g + h + i;
+    }
+
+    int base = 100;
+};
+
 val embind_test_getglobal() {
     return val::global();
 }
@@ -1466,6 +1486,39 @@ EMSCRIPTEN_BINDINGS(memory_view_tests) {
     function("callWithMemoryView", &callWithMemoryView);
 }
 
+static std::vector<double> returnDoubleVector(size_t size) {
+    std::vector<double> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = i + 0.5;
+    }
+    return v;
+}
+
+static int sumShortVector(const std::vector<short>& v) {
+    int sum = 0;
+    for (short s : v) {
+        sum += s;
+    }
+    return sum;
+}
+
+static std::vector<short> negateShortVector(std::vector<short> v) {
+    for (short& s : v) {
+        s = -s;
+    }
+    return v;
+}
+
+EMSCRIPTEN_BINDINGS(typed_array_vector_tests) {
+    register_vector_as_typed_array<double>("DoubleTypedArrayVector");
+    register_vector_as_typed_array<short>("ShortTypedArrayVector");
+
+    function("returnDoubleVector", &returnDoubleVector);
+    function("returnDoubleVectorView", &returnDoubleVector, return_typed_array_view());
+    function("sumShortVector", &sumShortVector);
+    function("negateShortVector", &negateShortVector);
+}
+
 class HasExternalConstructor {
 public:
     HasExternalConstructor(const std::string& str)
@@ -2242,6 +2295,13 @@ EMSCRIPTEN_BINDINGS(tests) {
 
     function("test_string_with_vec", &test_string_with_vec);
 
+    function("sum_8_args", &sum_8_args);
+    function("join_10_args", &join_10_args);
+    class_<ManyArgs>("ManyArgs")
+        .constructor<>()
+        .function("sum", &ManyArgs::sum)
+        ;
+
     register_map<std::string, int>("StringIntMap");
     function("embind_test_get_string_int_map", embind_test_get_string_int_map);
 
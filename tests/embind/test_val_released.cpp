@@ -0,0 +1,80 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Checks that, with ASSERTIONS, using a val handle after it has been released
+// throws, even once its slot holds another value, and that count_emval_handles
+// stays right as slots are reused.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <emscripten/emscripten.h>
+#include <emscripten/val.h>
+
+using namespace emscripten;
+
+static int count_handles() {
+  return EM_ASM_INT({ return Module['count_emval_handles'](); });
+}
+
+// Prints the error that using the handle throws, if any.
+static void use(EM_VAL handle) {
+  EM_ASM({
+    try {
+      Emval.toValue($0);
+      out('toValue: ok');
+    } catch (e) {
+      out('toValue: ' + e.name + ': ' + e.message.replace(/handle = .*/, 'handle = ...'));
+    }
+    try {
+      __emval_incref($0);
+      __emval_decref($0);
+      out('incref: ok');
+    } catch (e) {
+      out('incref: ' + e.name);
+    }
+  }, handle);
+}
+
+int main() {
+  int base = count_handles();
+
+  val a = val::object();
+  EM_VAL stale = a.as_handle();
+  printf("after object: %d\n", count_handles() - base);
+  use(stale);
+
+  a = val::null();
+  printf("after release: %d\n", count_handles() - base);
+  use(stale);
+
+  // The next value takes the freed slot, but under a new handle.
+  val b = val::array();
+  EM_VAL fresh = b.as_handle();
+  printf("slot reused: %d, same handle: %d\n",
+         ((uintptr_t)fresh & 0xFFFFFF) == ((uintptr_t)stale & 0xFFFFFF), fresh == stale);
+  printf("after array: %d\n", count_handles() - base);
+  use(stale);
+  use(fresh);
+
+  // Grow the tables, free everything, and fill the slots again.
+  std::vector<val> vals;
+  for (int i = 0; i < 100; i++) {
+    vals.push_back(val::object());
+  }
+  printf("after 100 more: %d\n", count_handles() - base);
+  vals.clear();
+  printf("after clearing: %d\n", count_handles() - base);
+  for (int i = 0; i < 50; i++) {
+    vals.push_back(val(i));
+  }
+  vals.push_back(vals[0]);
+  printf("after 50 more and a copy: %d\n", count_handles() - base);
+  vals.clear();
+  b = val::undefined();
+  printf("at the end: %d\n", count_handles() - base);
+  use(fresh);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Closes waitable fetches on the main thread while they are still queued or
+// running on the fetch thread, which aborts them there, and then checks that
+// the fetch thread still completes a new fetch.
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emscripten/emscripten.h>
+#include <emscripten/eventloop.h>
+#include <emscripten/fetch.h>
+
+// More than the fetch thread runs at once, so that some are still queued.
+#define NUM_CLOSED 8
+
+static int num_aborted;
+static int num_succeeded;
+static emscripten_fetch_t* last_fetch;
+
+static void on_success(emscripten_fetch_t* fetch) {
+  assert(fetch == last_fetch);
+  assert(fetch->status == 200);
+  assert(fetch->numBytes == 6407);
+  num_succeeded++;
+}
+
+static void on_error(emscripten_fetch_t* fetch) {
+  assert(fetch->status == (unsigned short)-1);
+  assert(!strcmp(fetch->statusText, "aborted with emscripten_fetch_close()"));
+  num_aborted++;
+}
+
+static emscripten_fetch_t* start_fetch() {
+  emscripten_fetch_attr_t attr;
+  emscripten_fetch_attr_init(&attr);
+  strcpy(attr.requestMethod, "GET");
+  attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_WAITABLE | EMSCRIPTEN_FETCH_REPLACE;
+  attr.onsuccess = on_success;
+  attr.onerror = on_error;
+  emscripten_fetch_t* fetch = emscripten_fetch(&attr, "gears.png");
+  assert(fetch);
+  return fetch;
+}
+
+static void poll(void* arg) {
+  // The main thread cannot block, but it can check whether the fetch is done,
+  // which also runs its callbacks.
+  if (emscripten_fetch_wait(last_fetch, 0) != EMSCRIPTEN_RESULT_SUCCESS) {
+    emscripten_set_timeout(poll, 10, 0);
+    return;
+  }
+  assert(num_succeeded == 1);
+  assert(num_aborted == NUM_CLOSED);
+  emscripten_fetch_close(last_fetch);
+  printf("closed %d fetches in flight\n", num_aborted);
+  exit(0);
+}
+
+int main() {
+  for (int i = 0; i < NUM_CLOSED; ++i) {
+    emscripten_fetch_t* fetch = start_fetch();
+    EMSCRIPTEN_RESULT result = emscripten_fetch_close(fetch);
+    assert(result == EMSCRIPTEN_RESULT_SUCCESS);
+  }
+  assert(num_aborted == NUM_CLOSED);
+  last_fetch = start_fetch();
+  emscripten_set_timeout(poll, 10, 0);
+  return 0;
+}
@@ -0,0 +1,59 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <assert.h>
+#include <atomic>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <emscripten/fetch.h>
+
+#define NUM_THREADS 8
+
+static std::atomic<int> num_successes;
+static thread_local bool is_fetching_thread;
+
+static void check_data(emscripten_fetch_t* fetch) {
+  assert(fetch->status == 200);
+  assert(fetch->numBytes == 6407);
+  assert(fetch->data != 0);
+  uint8_t checksum = 0;
+  for (int i = 0; i < fetch->numBytes; ++i)
+    checksum ^= fetch->data[i];
+  assert(checksum == 0x08);
+}
+
+static void* thread_main(void* arg) {
+  is_fetching_thread = true;
+  // Each thread blocks on a fetch that reads the file from IndexedDB, or
+  // downloads and stores it there if no other thread has done so yet.
+  emscripten_fetch_attr_t attr;
+  emscripten_fetch_attr_init(&attr);
+  strcpy(attr.requestMethod, "GET");
+  attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_PERSIST_FILE | EMSCRIPTEN_FETCH_SYNCHRONOUS;
+  attr.onsuccess = [](emscripten_fetch_t* fetch) {
+    // Runs on the calling thread before emscripten_fetch() returns.
+    assert(is_fetching_thread);
+    num_successes++;
+  };
+  emscripten_fetch_t* fetch = emscripten_fetch(&attr, "gears.png");
+  assert(fetch);
+  check_data(fetch);
+  emscripten_fetch_close(fetch);
+  return 0;
+}
+
+int main() {
+  pthread_t threads[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    pthread_create(&threads[i], 0, thread_main, 0);
+  }
+  for (int i = 0; i < NUM_THREADS; ++i) {
+    pthread_join(threads[i], 0);
+  }
+  printf("%d threads fetched gears.png\n", num_successes.load());
+  assert(num_successes == NUM_THREADS);
+  return 0;
+}
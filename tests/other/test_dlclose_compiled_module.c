@@ -0,0 +1,32 @@
+#include <emscripten/emscripten.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+#include <stdio.h>
+
+static int num_compiled_modules() {
+  return EM_ASM_INT({ return Object.keys(LDSO.compiledModules).length; });
+}
+
+void onsuccess(void *user_data, void *handle) {
+  printf("compiled modules after emscripten_dlopen: %d\n", num_compiled_modules());
+
+  // Opening the library again only adds a reference.
+  void* handle2 = dlopen("libside.so", RTLD_NOW);
+  assert(handle2 == handle);
+  assert(dlclose(handle2) == 0);
+  printf("compiled modules after first dlclose: %d\n", num_compiled_modules());
+
+  assert(dlclose(handle) == 0);
+  printf("compiled modules after last dlclose: %d\n", num_compiled_modules());
+  exit(0);
+}
+
+void onerror(void *user_data) {
+  printf("onerror %s\n", dlerror());
+}
+
+int main() {
+  emscripten_dlopen("libside.so", RTLD_NOW, NULL, onsuccess, onerror);
+  return 99;
+}
@@ -0,0 +1,33 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define NUM_THREADS 4
+#define ITERATIONS 20
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static int counter;
+
+static void* thread_main(void* arg) {
+  for (int i = 0; i < ITERATIONS; i++) {
+    pthread_mutex_lock(&mutex);
+    // Hold the lock long enough that the other threads have to block on it.
+    usleep(1000);
+    counter++;
+    pthread_mutex_unlock(&mutex);
+  }
+  return NULL;
+}
+
+int main() {
+  pthread_t threads[NUM_THREADS];
+  for (int i = 0; i < NUM_THREADS; i++) {
+    pthread_create(&threads[i], NULL, thread_main, NULL);
+  }
+  for (int i = 0; i < NUM_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  printf("counter: %d\n", counter);
+  printf("mutex: %lu %lu\n", (unsigned long)&mutex, (unsigned long)sizeof(mutex));
+  return 0;
+}
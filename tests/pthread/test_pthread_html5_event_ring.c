@@ -0,0 +1,110 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Sends html5 events to callbacks on a pthread, which get them through the
+// thread's event ring: mousemoves and wheels that may be coalesced, and more
+// keydowns than the ring holds, so that some take the queued call path. The
+// thread checks that every event arrives in order and nothing is lost.
+
+#include <assert.h>
+#include <emscripten.h>
+#include <emscripten/eventloop.h>
+#include <emscripten/html5.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_MOVES 20
+#define NUM_WHEELS 10
+#define NUM_KEYS 100
+
+static atomic_int ready;
+static pthread_t thread;
+
+static int num_moves;
+static int movement_x;
+static int num_wheels;
+static double wheel_delta;
+static int num_keys;
+
+static EM_BOOL on_mousemove(int eventType, const EmscriptenMouseEvent* e, void* userData) {
+  assert(pthread_equal(pthread_self(), thread));
+  assert(userData == (void*)1);
+  num_moves++;
+  movement_x += e->movementX;
+  return 0;
+}
+
+static EM_BOOL on_wheel(int eventType, const EmscriptenWheelEvent* e, void* userData) {
+  assert(pthread_equal(pthread_self(), thread));
+  assert(userData == (void*)2);
+  // Every wheel comes after every mousemove.
+  assert(movement_x == 2 * NUM_MOVES);
+  num_wheels++;
+  wheel_delta += e->deltaY;
+  return 0;
+}
+
+static EM_BOOL on_keydown(int eventType, const EmscriptenKeyboardEvent* e, void* userData) {
+  assert(pthread_equal(pthread_self(), thread));
+  assert(userData == (void*)3);
+  assert(wheel_delta == NUM_WHEELS);
+  // Key events are never coalesced.
+  assert(atoi(e->key) == num_keys);
+  num_keys++;
+  return 0;
+}
+
+static EM_BOOL on_keyup(int eventType, const EmscriptenKeyboardEvent* e, void* userData) {
+  assert(pthread_equal(pthread_self(), thread));
+  printf("keys: %d, movement: %d, wheel delta: %g\n", num_keys, movement_x, wheel_delta);
+  assert(num_keys == NUM_KEYS);
+  assert(movement_x == 2 * NUM_MOVES);
+  assert(num_moves >= 1 && num_moves <= NUM_MOVES);
+  assert(wheel_delta == NUM_WHEELS);
+  assert(num_wheels >= 1 && num_wheels <= NUM_WHEELS);
+  exit(0);
+  return 0;
+}
+
+static void* thread_main(void* arg) {
+  ready = 1;
+  // Stay alive to run the callbacks.
+  emscripten_exit_with_live_runtime();
+  return NULL;
+}
+
+static void send_events(void* arg) {
+  if (!ready) {
+    emscripten_set_timeout(send_events, 10, 0);
+    return;
+  }
+
+  emscripten_set_mousemove_callback_on_thread(EMSCRIPTEN_EVENT_TARGET_WINDOW, (void*)1, 1, on_mousemove, thread);
+  emscripten_set_wheel_callback_on_thread(EMSCRIPTEN_EVENT_TARGET_WINDOW, (void*)2, 1, on_wheel, thread);
+  emscripten_set_keydown_callback_on_thread(EMSCRIPTEN_EVENT_TARGET_WINDOW, (void*)3, 1, on_keydown, thread);
+  emscripten_set_keyup_callback_on_thread(EMSCRIPTEN_EVENT_TARGET_WINDOW, (void*)4, 1, on_keyup, thread);
+
+  EM_ASM({
+    for (var i = 0; i < $0; i++) {
+      window.dispatchEvent(new MouseEvent('mousemove', { movementX: 2 }));
+    }
+    for (var i = 0; i < $1; i++) {
+      window.dispatchEvent(new WheelEvent('wheel', { deltaY: 1, deltaMode: 0 }));
+    }
+    for (var i = 0; i < $2; i++) {
+      window.dispatchEvent(new KeyboardEvent('keydown', { key: String(i) }));
+    }
+    window.dispatchEvent(new KeyboardEvent('keyup', { key: 'end' }));
+  }, NUM_MOVES, NUM_WHEELS, NUM_KEYS);
+}
+
+int main() {
+  pthread_create(&thread, NULL, thread_main, NULL);
+  emscripten_set_timeout(send_events, 0, 0);
+  emscripten_exit_with_live_runtime();
+  return 0;
+}
@@ -0,0 +1,71 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Measures how long the browser event loop stalls while the main thread waits
+// for a mutex that a pthread holds for HOLD_MS. With busy-waiting the event
+// loop cannot run at all during the wait, while with MAIN_THREAD_ASYNC_WAITS
+// it keeps running and the main thread is idle.
+
+#include <assert.h>
+#include <emscripten.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define HOLD_MS 1000
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int locked;
+
+static void* hold_mutex(void* arg) {
+  pthread_mutex_lock(&mutex);
+  locked = 1;
+  double start = emscripten_get_now();
+  while (emscripten_get_now() - start < HOLD_MS) {
+  }
+  pthread_mutex_unlock(&mutex);
+  return NULL;
+}
+
+int main() {
+  pthread_t thread;
+  pthread_create(&thread, NULL, hold_mutex, NULL);
+  while (!locked) {
+  }
+
+  // Record the longest gap between ticks of a 1ms interval timer.
+  EM_ASM({
+    var last = performance.now();
+    Module.maxStall = 0;
+    Module.ticker = setInterval(function() {
+      var now = performance.now();
+      Module.maxStall = Math.max(Module.maxStall, now - last);
+      last = now;
+    }, 1);
+  });
+
+  double start = emscripten_get_now();
+  pthread_mutex_lock(&mutex);
+  double waited = emscripten_get_now() - start;
+  pthread_mutex_unlock(&mutex);
+
+  // Let the timer tick once more, so that a stall that lasted until now is
+  // counted too.
+  emscripten_sleep(20);
+  double stall = EM_ASM_DOUBLE({
+    clearInterval(Module.ticker);
+    return Module.maxStall;
+  });
+  printf("waited %.0f ms, longest event loop stall %.0f ms\n", waited, stall);
+
+#ifdef ASYNC_WAITS
+  assert(stall < HOLD_MS / 2);
+#else
+  assert(stall >= HOLD_MS / 2);
+#endif
+
+  pthread_join(thread, NULL);
+  return 0;
+}
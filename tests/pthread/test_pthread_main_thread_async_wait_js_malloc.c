@@ -0,0 +1,50 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Calls _malloc from JS, outside of any other wasm call, while a pthread keeps
+// the malloc lock busy. JS expects _malloc to return synchronously, so with
+// MAIN_THREAD_ASYNC_WAITS a contended wait in there must spin rather than
+// suspend the program.
+
+#include <assert.h>
+#include <emscripten.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+static atomic_int running = 1;
+static pthread_t thread;
+
+static void* churn(void* arg) {
+  while (running) {
+    free(malloc(16));
+  }
+  return NULL;
+}
+
+EMSCRIPTEN_KEEPALIVE void finish(int ok) {
+  running = 0;
+  pthread_join(thread, NULL);
+  exit(ok ? 0 : 1);
+}
+
+int main() {
+  pthread_create(&thread, NULL, churn, NULL);
+
+  EM_ASM({
+    setTimeout(function() {
+      var ok = true;
+      for (var i = 0; i < 100000 && ok; i++) {
+        var ptr = _malloc(16);
+        ok = ptr && !Asyncify.currData;
+        _free(ptr);
+      }
+      if (!ok) err('_malloc did not return synchronously');
+      _finish(ok);
+    }, 0);
+  });
+  emscripten_exit_with_live_runtime();
+  return 0;
+}
@@ -0,0 +1,69 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+// Creates threads in bursts of PTHREAD_POOL_LOW_WATER from the main loop, which
+// only works under PTHREAD_POOL_SIZE_STRICT=2 if the pool is refilled in
+// between, and then checks that the extra Workers this leaves in the pool are
+// retired after PTHREAD_POOL_IDLE_TIMEOUT.
+
+#include <assert.h>
+#include <emscripten.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOW_WATER 2
+#define BURSTS 10
+
+static atomic_int ran;
+static pthread_t threads[LOW_WATER];
+static int joined = LOW_WATER;
+static int bursts;
+static double finished;
+
+static void* thread_main(void* arg) {
+  ran++;
+  return NULL;
+}
+
+static void loop() {
+  while (joined < LOW_WATER && pthread_tryjoin_np(threads[joined], NULL) == 0) {
+    joined++;
+  }
+  if (joined < LOW_WATER) {
+    return;
+  }
+
+  if (bursts < BURSTS) {
+    for (int i = 0; i < LOW_WATER; i++) {
+      int rc = pthread_create(&threads[i], NULL, thread_main, NULL);
+      assert(rc == 0);
+    }
+    joined = 0;
+    bursts++;
+    return;
+  }
+
+  if (!finished) {
+    assert(ran == BURSTS * LOW_WATER);
+    printf("ran %d threads\n", ran);
+    finished = emscripten_get_now();
+  }
+  // Wait for the idle timeout to pass, and check the surplus was retired.
+  if (emscripten_get_now() - finished < 500) {
+    return;
+  }
+  int unused = EM_ASM_INT({ return PThread.unusedWorkers.length; });
+  printf("unused workers: %d\n", unused);
+  assert(unused == LOW_WATER);
+  emscripten_cancel_main_loop();
+  exit(0);
+}
+
+int main() {
+  emscripten_set_main_loop(loop, 0, 0);
+  return 0;
+}
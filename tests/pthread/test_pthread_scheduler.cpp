@@ -0,0 +1,56 @@
+// Copyright 2021 The Emscripten Authors.  All rights reserved.
+// Emscripten is available under two separate licenses, the MIT license and the
+// University of Illinois/NCSA Open Source License.  Both these licenses can be
+// found in the LICENSE file.
+
+#include <assert.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <vector>
+
+#include <emscripten/scheduler.h>
+
+static int fib(int n) {
+  if (n < 2) {
+    return n;
+  }
+  int a, b;
+  emscripten::task_group group;
+  group.run([&] { a = fib(n - 1); });
+  b = fib(n - 2);
+  group.wait();
+  return a + b;
+}
+
+static void add_one(size_t begin, size_t end, void* arg) {
+  int* values = (int*)arg;
+  for (size_t i = begin; i < end; i++) {
+    values[i]++;
+  }
+}
+
+int main() {
+  int workers = emscripten_scheduler_init(4);
+  printf("workers: %d\n", workers);
+  assert(emscripten_scheduler_num_workers() == workers);
+
+  std::vector<int> values(100000);
+  for (int i = 0; i < 10; i++) {
+    emscripten_parallel_for(0, values.size(), 1000, add_one, values.data());
+  }
+  for (int value : values) {
+    assert(value == 10);
+  }
+
+  std::atomic<long long> sum(0);
+  emscripten::parallel_for(0, 10000, [&](size_t i) { sum += i; }, 100);
+  printf("sum: %lld\n", sum.load());
+
+  printf("fib: %d\n", fib(20));
+
+  emscripten_scheduler_shutdown();
+  assert(emscripten_scheduler_num_workers() == 0);
+  printf("done\n");
+  return 0;
+}
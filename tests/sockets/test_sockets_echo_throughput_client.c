@@ -0,0 +1,128 @@
+/*
+ * Copyright 2021 The Emscripten Authors.  All rights reserved.
+ * Emscripten is available under two separate licenses, the MIT license and the
+ * University of Illinois/NCSA Open Source License.  Both these licenses can be
+ * found in the LICENSE file.
+ */
+
+// Measures stream socket throughput against test_sockets_echo_server.c by
+// sending a single large message in many small send() calls and reading the
+// echo back in many small recv() calls.
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <emscripten.h>
+
+#ifndef MESSAGE_SIZE
+#define MESSAGE_SIZE (4 * 1024 * 1024)
+#endif
+
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE 64
+#endif
+
+int fd;
+char *message;
+char *echo;
+int wrote = -(int)sizeof(int); // the length header is sent first
+int read_header;
+int echo_read;
+double start;
+
+void finish(int result) {
+  close(fd);
+  emscripten_force_exit(result);
+}
+
+void main_loop() {
+  int res;
+
+  while (wrote < MESSAGE_SIZE) {
+    if (wrote < 0) {
+      int length = MESSAGE_SIZE;
+      res = send(fd, &length, sizeof(int), 0);
+    } else {
+      int max = MESSAGE_SIZE - wrote;
+      res = send(fd, message + wrote, max < CHUNK_SIZE ? max : CHUNK_SIZE, 0);
+    }
+    if (res == -1) {
+      assert(errno == EAGAIN);
+      return;
+    }
+    wrote += res;
+  }
+
+  if (!read_header) {
+    int length;
+    res = recv(fd, &length, sizeof(int), 0);
+    if (res == -1) {
+      assert(errno == EAGAIN);
+      return;
+    }
+    assert(res == sizeof(int));
+    assert(length == MESSAGE_SIZE);
+    read_header = 1;
+  }
+
+  while (echo_read < MESSAGE_SIZE) {
+    int max = MESSAGE_SIZE - echo_read;
+    res = recv(fd, echo + echo_read, max < CHUNK_SIZE ? max : CHUNK_SIZE, 0);
+    if (res == -1) {
+      assert(errno == EAGAIN);
+      return;
+    } else if (res == 0) {
+      perror("server closed");
+      finish(EXIT_FAILURE);
+    }
+    echo_read += res;
+  }
+
+  double elapsed = emscripten_get_now() - start;
+  assert(!memcmp(message, echo, MESSAGE_SIZE));
+  printf("echoed %d bytes in %d byte chunks: %.2f ms (%.2f MB/s)\n",
+         MESSAGE_SIZE, CHUNK_SIZE, elapsed,
+         2 * MESSAGE_SIZE / (elapsed / 1000) / (1024 * 1024));
+  finish(EXIT_SUCCESS);
+}
+
+int main() {
+  struct sockaddr_in addr;
+
+  message = malloc(MESSAGE_SIZE);
+  echo = malloc(MESSAGE_SIZE);
+  for (int i = 0; i < MESSAGE_SIZE; i++) {
+    message[i] = i * 7;
+  }
+
+  fd = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd == -1) {
+    perror("cannot create socket");
+    return EXIT_FAILURE;
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(SOCKK);
+  if (inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr) != 1) {
+    perror("inet_pton failed");
+    return EXIT_FAILURE;
+  }
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 && errno != EINPROGRESS) {
+    perror("connect failed");
+    return EXIT_FAILURE;
+  }
+
+  start = emscripten_get_now();
+  emscripten_set_main_loop(main_loop, 0, 0);
+  return EXIT_SUCCESS;
+}
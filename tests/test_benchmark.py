@@ -246,8 +246,9 @@ class EmscriptenBenchmarker(Benchmarker):
 
 
 class EmscriptenWasm2CBenchmarker(EmscriptenBenchmarker):
-  def __init__(self, name):
+  def __init__(self, name, sandboxing='full'):
     super().__init__(name, 'no engine needed')
+    self.sandboxing = sandboxing
 
   def build(self, parent, filename, args, shared_args, emcc_args, native_args, native_exec, lib_builder, has_output_parser):
     # wasm2c doesn't want minimal runtime which the normal emscripten
@@ -255,7 +256,8 @@ class EmscriptenWasm2CBenchmarker(EmscriptenBenchmarker):
     emcc_args = emcc_args + [
       '-s', 'STANDALONE_WASM',
       '-s', 'MINIMAL_RUNTIME=0',
-      '-s', 'WASM2C'
+      '-s', 'WASM2C',
+      '-s', 'WASM2C_SANDBOXING=' + self.sandboxing
     ]
 
     global LLVM_FEATURE_FLAGS
@@ -379,7 +381,8 @@ if config.V8_ENGINE and config.V8_ENGINE in config.JS_ENGINES:
     benchmarkers += [
       EmscriptenBenchmarker(default_v8_name, aot_v8),
       EmscriptenBenchmarker(default_v8_name + '-lto', aot_v8, ['-flto']),
-      # EmscriptenWasm2CBenchmarker('wasm2c')
+      # EmscriptenWasm2CBenchmarker('wasm2c'),
+      # EmscriptenWasm2CBenchmarker('wasm2c-guard', 'guard'),
     ]
   if os.path.exists(CHEERP_BIN):
     benchmarkers += [
@@ -557,6 +560,253 @@ class benchmark(common.RunnerCore):
     '''
     self.do_benchmark('memops', src, 'final:')
 
+  # Benchmarks path resolution in the filesystem, by stat()ing and open()ing
+  # files in a deep directory tree.
+  @non_core
+  def test_fs_lookup(self):
+    src = r'''
+      #include <fcntl.h>
+      #include <stdio.h>
+      #include <string.h>
+      #include <sys/stat.h>
+      #include <unistd.h>
+
+      #define DEPTH 12
+      #define FILES 16
+
+      int main(int argc, char **argv) {
+        int N;
+        int arg = argc > 1 ? argv[1][0] - '0' : 3;
+        switch(arg) {
+          case 0: return 0; break;
+          case 1: N = 10000; break;
+          case 2: N = 50000; break;
+          case 3: N = 100000; break;
+          case 4: N = 200000; break;
+          case 5: N = 400000; break;
+          default: printf("error: %d\\n", arg); return -1;
+        }
+
+        char dir[1024] = "fs_lookup";
+        mkdir(dir, 0777);
+        for (int i = 0; i < DEPTH; i++) {
+          sprintf(dir + strlen(dir), "/directory%d", i);
+          mkdir(dir, 0777);
+        }
+        char paths[FILES][1024];
+        for (int i = 0; i < FILES; i++) {
+          sprintf(paths[i], "%s/file%d.txt", dir, i);
+          close(open(paths[i], O_WRONLY | O_CREAT | O_TRUNC, 0666));
+        }
+
+        int total = 0;
+        for (int i = 0; i < N; i++) {
+          struct stat st;
+          total += stat(paths[i % FILES], &st) == 0;
+          int fd = open(paths[(i * 7) % FILES], O_RDONLY);
+          total += fd >= 0;
+          close(fd);
+        }
+        printf("total: %d.\\n", total);
+        return 0;
+      }
+    '''
+    self.do_benchmark('fs_lookup', src, 'total:', force_c=True)
+
+  # Benchmarks writing lots of lines to stdout, which is dominated by the cost
+  # of getting the output through the JS side of the file descriptor.
+  @non_core
+  def test_printf_throughput(self):
+    src = r'''
+      #include <stdio.h>
+
+      int main(int argc, char **argv) {
+        int N;
+        int arg = argc > 1 ? argv[1][0] - '0' : 3;
+        switch(arg) {
+          case 0: return 0; break;
+          case 1: N = 20000; break;
+          case 2: N = 100000; break;
+          case 3: N = 200000; break;
+          case 4: N = 400000; break;
+          case 5: N = 800000; break;
+          default: printf("error: %d\\n", arg); return -1;
+        }
+
+        for (int i = 0; i < N; i++) {
+          printf("log line %d: the quick brown fox jumps over the lazy dog\\n", i);
+        }
+        printf("lines: %d.\\n", N);
+        return 0;
+      }
+    '''
+    self.do_benchmark('printf_throughput', src, 'lines:', force_c=True)
+
+  # Measures contended pthread mutexes with short critical sections, and a
+  # condition variable ping-pong between two threads, which is where spinning
+  # before parking on a futex matters most.
+  @non_core
+  def test_mutex_contention(self):
+    src = r'''
+      #include <pthread.h>
+      #include <stdio.h>
+      #include <time.h>
+
+      static int iterations;
+      static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+      static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+      static volatile int counter;
+      static int turn;
+
+      static double now() {
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+      }
+
+      static void *increment(void *arg) {
+        for (int i = 0; i < iterations; i++) {
+          pthread_mutex_lock(&mutex);
+          // A short critical section.
+          for (int j = 0; j < 10; j++) {
+            counter++;
+          }
+          pthread_mutex_unlock(&mutex);
+        }
+        return NULL;
+      }
+
+      static void *ping_pong(void *arg) {
+        int self = (int)(long)arg;
+        for (int i = 0; i < iterations / 10; i++) {
+          pthread_mutex_lock(&mutex);
+          while (turn != self) {
+            pthread_cond_wait(&cond, &mutex);
+          }
+          turn = !self;
+          pthread_cond_signal(&cond);
+          pthread_mutex_unlock(&mutex);
+        }
+        return NULL;
+      }
+
+      int main(int argc, char **argv) {
+        int arg = argc > 1 ? argv[1][0] - '0' : 3;
+        switch(arg) {
+          case 0: return 0; break;
+          case 1: iterations = 10000; break;
+          case 2: iterations = 50000; break;
+          case 3: iterations = 100000; break;
+          case 4: iterations = 200000; break;
+          case 5: iterations = 400000; break;
+          default: printf("error: %d\\n", arg); return -1;
+        }
+
+        pthread_t threads[8];
+        for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+          counter = 0;
+          double start = now();
+          for (int i = 0; i < num_threads; i++) {
+            pthread_create(&threads[i], NULL, increment, NULL);
+          }
+          for (int i = 0; i < num_threads; i++) {
+            pthread_join(threads[i], NULL);
+          }
+          double elapsed = now() - start;
+          if (counter != num_threads * iterations * 10) {
+            printf("error: counter is %d\\n", counter);
+            return 1;
+          }
+          printf("mutex, %d threads: %.1f ns per lock\\n", num_threads,
+                 elapsed * 1000000 / (num_threads * iterations));
+        }
+
+        double start = now();
+        for (int i = 0; i < 2; i++) {
+          pthread_create(&threads[i], NULL, ping_pong, (void*)(long)i);
+        }
+        for (int i = 0; i < 2; i++) {
+          pthread_join(threads[i], NULL);
+        }
+        double elapsed = now() - start;
+        printf("condvar ping-pong: %.1f us per round trip\\n", elapsed * 1000 / (iterations / 10));
+        printf("done.\\n");
+        return 0;
+      }
+    '''
+    self.do_benchmark('mutex_contention', src, 'done.', force_c=True,
+                      emcc_args=['-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE=8', '-s', 'EXIT_RUNTIME'],
+                      native_args=['-pthread'])
+
+  # Measures how the work-stealing scheduler in emscripten/scheduler.h scales
+  # from 1 to 16 worker threads on an uneven workload (mandelbrot rows). Only
+  # runs on emscripten, and prints the time for each worker count.
+  @non_core
+  def test_scheduler_scaling(self):
+    src = r'''
+      #include <stdio.h>
+      #include <stdlib.h>
+      #include <emscripten.h>
+      #include <emscripten/scheduler.h>
+
+      static int size;
+      static int *iterations;
+
+      static void rows(size_t begin, size_t end, void *arg) {
+        for (size_t y = begin; y < end; y++) {
+          for (int x = 0; x < size; x++) {
+            double cr = 2.5 * x / size - 2, ci = 2.0 * y / size - 1;
+            double zr = 0, zi = 0;
+            int i = 0;
+            while (i < 1000 && zr * zr + zi * zi < 4) {
+              double t = zr * zr - zi * zi + cr;
+              zi = 2 * zr * zi + ci;
+              zr = t;
+              i++;
+            }
+            iterations[y * size + x] = i;
+          }
+        }
+      }
+
+      int main(int argc, char **argv) {
+        int arg = argc > 1 ? argv[1][0] - '0' : 3;
+        switch(arg) {
+          case 0: return 0; break;
+          case 1: size = 250; break;
+          case 2: size = 500; break;
+          case 3: size = 1000; break;
+          case 4: size = 1500; break;
+          case 5: size = 2000; break;
+          default: printf("error: %d\\n", arg); return -1;
+        }
+        iterations = (int*)malloc(size * size * sizeof(int));
+
+        double serial = 0;
+        for (int workers = 1; workers <= 16; workers *= 2) {
+          // The calling thread also runs tasks, so start one fewer worker.
+          emscripten_scheduler_init(workers - 1);
+          double start = emscripten_get_now();
+          emscripten_parallel_for(0, size, 1, rows, NULL);
+          double elapsed = emscripten_get_now() - start;
+          emscripten_scheduler_shutdown();
+          if (workers == 1) {
+            serial = elapsed;
+          }
+          printf("threads: %2d: %.2f ms (%.2fx)\\n", workers, elapsed, serial / elapsed);
+        }
+
+        long long sum = 0;
+        for (int i = 0; i < size * size; i++) {
+          sum += iterations[i];
+        }
+        printf("sum: %lld.\\n", sum);
+        return 0;
+      }
+    '''
+    self.do_benchmark('scheduler_scaling', src, 'sum:', force_c=True, skip_native=True,
+                      emcc_args=['-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE=15', '-s', 'EXIT_RUNTIME'])
+
   def zzztest_files(self):
     src = r'''
       #include <stdio.h>
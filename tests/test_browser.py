@@ -516,6 +516,24 @@ If manually bisecting:
     self.run_browser('page.html', 'You should see |load me right before|.', '/report_result?exit:0')
     self.run_browser('page.html', 'You should see |load me right before|.', '/report_result?exit:1')
 
+  def test_wasm_module_cache(self):
+    self.set_setting('EXIT_RUNTIME')
+    create_file('main.c', r'''
+      #include <emscripten.h>
+
+      int main() {
+        return EM_ASM_INT({ return Module['wasmFromCache'] });
+      }
+    ''')
+    self.compile_btest(['main.c', '-o', 'page.html', '-s', 'WASM_MODULE_CACHE'], reporting=Reporting.JS_ONLY)
+    # the first load populates the cache, the second is served from it
+    self.run_browser('page.html', None, '/report_result?exit:0')
+    self.run_browser('page.html', None, '/report_result?exit:1')
+    # a rebuilt binary must not be served the stale cache entry
+    self.compile_btest(['main.c', '-o', 'page.html', '-s', 'WASM_MODULE_CACHE', '-O1'], reporting=Reporting.JS_ONLY)
+    self.run_browser('page.html', None, '/report_result?exit:0')
+    self.run_browser('page.html', None, '/report_result?exit:1')
+
   def test_preload_caching_indexeddb_name(self):
     self.set_setting('EXIT_RUNTIME')
     create_file('somefile.txt', '''load me right before running the code please''')
@@ -3799,6 +3817,30 @@ window.close = function() {
       print('Test that everything works ok when we are on a pthread.')
       self.btest_exit(test_file('pthread/main_thread_%s.cpp' % name), args=['-O3', '-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE', '-s', 'PROXY_TO_PTHREAD', '-s', 'ALLOW_BLOCKING_ON_MAIN_THREAD=0'])
 
+  # Compares how long the event loop stalls while the main thread waits for a
+  # mutex, when busy-waiting and with MAIN_THREAD_ASYNC_WAITS. This is not a
+  # CPU usage measurement, which pages can't take, and there is no such
+  # benchmark in test_benchmark.py either: the shells it runs in block with
+  # Atomics.wait on the main thread, so neither variant spins there.
+  @requires_threads
+  def test_pthread_main_thread_async_wait(self):
+    args = ['-O2', '-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE=1', '-s', 'ASYNCIFY']
+    print('busy-waiting')
+    self.btest_exit(test_file('pthread/test_pthread_main_thread_async_wait.c'), args=args)
+    print('MAIN_THREAD_ASYNC_WAITS')
+    self.btest_exit(test_file('pthread/test_pthread_main_thread_async_wait.c'), args=args + ['-s', 'MAIN_THREAD_ASYNC_WAITS', '-DASYNC_WAITS'])
+
+  # Waits in wasm called from JS glue must not suspend with
+  # MAIN_THREAD_ASYNC_WAITS, as the JS expects a synchronous result.
+  @requires_threads
+  def test_pthread_main_thread_async_wait_js_malloc(self):
+    self.btest_exit(test_file('pthread/test_pthread_main_thread_async_wait_js_malloc.c'), args=['-O2', '-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE=1', '-s', 'ASYNCIFY', '-s', 'MAIN_THREAD_ASYNC_WAITS', '-s', 'EXPORTED_FUNCTIONS=_main,_malloc,_free,_finish'])
+
+  # html5 events for callbacks on a pthread go through the thread's event ring.
+  @requires_threads
+  def test_pthread_html5_event_ring(self):
+    self.btest_exit(test_file('pthread/test_pthread_html5_event_ring.c'), args=['-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE=1'])
+
   # Test the old GCC atomic __sync_fetch_and_op builtin operations.
   @requires_threads
   def test_pthread_gcc_atomic_fetch_and_op(self):
@@ -4634,22 +4676,33 @@ window.close = function() {
                     args=['-s', 'FETCH_DEBUG', '-s', 'FETCH', '--proxy-to-worker'])
 
   # Tests waiting on EMSCRIPTEN_FETCH_WAITABLE request from a worker thread
-  @no_wasm_backend("emscripten_fetch_wait uses an asm.js based web worker")
   @requires_threads
   def test_fetch_sync_fetch_in_main_thread(self):
     shutil.copyfile(test_file('gears.png'), 'gears.png')
-    self.btest_exit('fetch/sync_fetch_in_main_thread.cpp', args=['-s', 'FETCH_DEBUG', '-s', 'FETCH', '-s', 'WASM=0', '-s', 'USE_PTHREADS', '-s', 'PROXY_TO_PTHREAD'])
+    self.btest_exit('fetch/sync_fetch_in_main_thread.cpp', args=['-s', 'FETCH_DEBUG', '-s', 'FETCH', '-s', 'USE_PTHREADS', '-s', 'PROXY_TO_PTHREAD'])
 
   @requires_threads
-  @no_wasm_backend("WASM2JS does not yet support pthreads")
   def test_fetch_idb_store(self):
-    self.btest_exit('fetch/idb_store.cpp', args=['-s', 'USE_PTHREADS', '-s', 'FETCH', '-s', 'WASM=0', '-s', 'PROXY_TO_PTHREAD'])
+    self.btest_exit('fetch/idb_store.cpp', args=['-s', 'USE_PTHREADS', '-s', 'FETCH', '-s', 'PROXY_TO_PTHREAD'])
 
   @requires_threads
-  @no_wasm_backend("WASM2JS does not yet support pthreads")
   def test_fetch_idb_delete(self):
     shutil.copyfile(test_file('gears.png'), 'gears.png')
-    self.btest_exit('fetch/idb_delete.cpp', args=['-s', 'USE_PTHREADS', '-s', 'FETCH_DEBUG', '-s', 'FETCH', '-s', 'WASM=0', '-s', 'PROXY_TO_PTHREAD'])
+    self.btest_exit('fetch/idb_delete.cpp', args=['-s', 'USE_PTHREADS', '-s', 'FETCH_DEBUG', '-s', 'FETCH', '-s', 'PROXY_TO_PTHREAD'])
+
+  # Tests synchronous fetches that go through the IndexedDB cache from several
+  # pthreads at once, which all run on the fetch thread.
+  @requires_threads
+  def test_fetch_sync_cached_from_threads(self):
+    shutil.copyfile(test_file('gears.png'), 'gears.png')
+    self.btest_exit('fetch/sync_cached_from_threads.cpp', args=['-s', 'FETCH', '-s', 'USE_PTHREADS', '-s', 'PROXY_TO_PTHREAD', '-s', 'PTHREAD_POOL_SIZE=10'])
+
+  # Tests closing waitable fetches on the main thread while they are queued or
+  # running on the fetch thread.
+  @requires_threads
+  def test_fetch_close_in_flight_waitable(self):
+    shutil.copyfile(test_file('gears.png'), 'gears.png')
+    self.btest_exit('fetch/close_in_flight_waitable.cpp', args=['-s', 'FETCH', '-s', 'USE_PTHREADS', '-s', 'PTHREAD_POOL_SIZE=1'])
 
   @requires_asmfs
   @requires_threads
@@ -2434,6 +2434,20 @@ The current type of b is: 9
     self.set_setting('PTHREAD_POOL_SIZE', 1)
     self.do_run_in_out_file_test('pthread/test_pthread_nested_work_queue.c')
 
+  @node_pthreads
+  def test_pthread_pool_low_water(self):
+    self.set_setting('EXIT_RUNTIME')
+    self.set_setting('PTHREAD_POOL_LOW_WATER', 2)
+    self.set_setting('PTHREAD_POOL_IDLE_TIMEOUT', 100)
+    self.set_setting('PTHREAD_POOL_SIZE_STRICT', 2)
+    self.do_run_in_out_file_test('pthread/test_pthread_pool_low_water.c')
+
+  @node_pthreads
+  def test_pthread_scheduler(self):
+    self.set_setting('EXIT_RUNTIME')
+    self.set_setting('PTHREAD_POOL_SIZE', 4)
+    self.do_run_in_out_file_test('pthread/test_pthread_scheduler.cpp')
+
   @node_pthreads
   def test_pthread_thread_local_storage(self):
     self.set_setting('PROXY_TO_PTHREAD')
@@ -5927,6 +5941,7 @@ void* operator new(size_t size) {
   def test_fakestat(self):
     self.do_core_test('test_fakestat.c')
 
+  @also_with_standalone_wasm(wasm2c=True)
   def test_mmap(self):
     # ASan needs more memory, but that is set up separately
     if '-fsanitize=address' not in self.emcc_args:
@@ -5950,6 +5965,36 @@ void* operator new(size_t size) {
       create_file('data.dat', s)
       self.do_runf(test_file('mmap_file.c'), '*\n' + s[0:20] + '\n' + s[4096:4096 + 20] + '\n*\n')
 
+  @also_with_standalone_wasm(wasm2c=True, impure=True)
+  def test_mmap_file_offset(self):
+    create_file('data.dat', ''.join(chr(ord('a') + i % 26) for i in range(4 * 4096 + 100)))
+    args = ['--embed-file', 'data.dat']
+    if self.get_setting('STANDALONE_WASM'):
+      args += ['-DHOST_OPEN', '--js-library', test_file('core/test_mmap_file_offset.js')]
+    self.do_core_test('test_mmap_file_offset.c', emcc_args=args)
+    # In guard page mode the wasm2c runtime maps the file into linear memory
+    # rather than reading it.
+    if self.get_setting('WASM2C'):
+      print('guard pages')
+      self.set_setting('WASM2C_SANDBOXING', 'guard')
+      # The test empties the file.
+      create_file('data.dat', ''.join(chr(ord('a') + i % 26) for i in range(4 * 4096 + 100)))
+      self.do_core_test('test_mmap_file_offset.c', emcc_args=args)
+
+  @parameterized({
+    '': ([],),
+    'grow': (['-sALLOW_MEMORY_GROWTH'],)
+  })
+  def test_mmap_shared(self, args):
+    self.set_setting('MEMFS_SHARED_MMAP')
+    self.emcc_args += args
+    self.do_core_test('test_mmap_shared.c')
+
+  def test_mmap_shared_private(self):
+    self.set_setting('MEMFS_SHARED_MMAP')
+    self.set_setting('ALLOW_MEMORY_GROWTH')
+    self.do_core_test('test_mmap_shared_private.c')
+
   @no_lsan('Test code contains memory leaks')
   def test_cubescript(self):
     # uses register keyword
@@ -6412,6 +6457,7 @@ void* operator new(size_t size) {
 
   @parameterized({
     'full': ('full',),
+    'guard': ('guard',),
     'mask': ('mask',),
     'none': ('none',),
   })
@@ -7013,6 +7059,11 @@ someweirdtext
     self.emcc_args += ['--bind']
     self.do_run_in_out_file_test('embind/test_val.cpp')
 
+  def test_embind_val_released(self):
+    self.set_setting('ASSERTIONS')
+    self.emcc_args += ['--bind']
+    self.do_run_in_out_file_test('embind/test_val_released.cpp')
+
   def test_embind_val_assignment(self):
     err = self.expect_fail([EMCC, test_file('embind/test_val_assignment.cpp'), '--bind', '-c'])
     self.assertContained('candidate function not viable: expects an lvalue for object argument', err)
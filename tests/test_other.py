@@ -9,6 +9,7 @@
 from functools import wraps
 import glob
 import gzip
+import hashlib
 import itertools
 import json
 import os
@@ -1687,6 +1688,43 @@ int f() {
         'side.wasm',
       ])
 
+  @node_pthreads
+  def test_dylink_pthread_compiled_modules(self):
+    # Test that a pthread instantiates the side modules that the main thread
+    # has compiled, rather than compiling them again.
+    create_file('side.c', 'int side() { return 42; }\n')
+    self.run_process([EMCC, 'side.c', '-o', 'side.wasm', '-pthread', '-Wno-experimental', '-s', 'SIDE_MODULE'])
+    create_file('pre.js', '''
+      var compiles = 0;
+      var origCompile = WebAssembly.compile;
+      WebAssembly.compile = function(bytes) {
+        compiles++;
+        return origCompile(bytes);
+      };
+    ''')
+    create_file('main.c', r'''
+      #include <emscripten.h>
+      #include <stdio.h>
+      int side();
+      int main() {
+        // With PROXY_TO_PTHREAD this runs on a pthread.
+        printf("side: %d\n", side());
+        printf("compiled on this thread: %d\n", EM_ASM_INT({ return compiles; }));
+        return 0;
+      }
+    ''')
+    self.do_smart_test(
+      'main.c',
+      ['side: 42', 'compiled on this thread: 0'],
+      emcc_args=[
+        '-pthread', '-Wno-experimental',
+        '-s', 'PROXY_TO_PTHREAD',
+        '-s', 'EXIT_RUNTIME=1',
+        '-s', 'MAIN_MODULE=1',
+        '--pre-js', 'pre.js',
+        'side.wasm',
+      ])
+
   def test_dylink_pthread_warning(self):
     err = self.expect_fail([EMCC, '-Werror', '-sMAIN_MODULE', '-sUSE_PTHREADS', test_file('hello_world.c')])
     self.assertContained('error: -s MAIN_MODULE + pthreads is experimental', err)
@@ -2324,10 +2362,18 @@ int f() {
     out = self.expect_fail([EMXX, test_file('embind/test_unsigned.cpp')])
     self.assertContained("undefined symbol: _embind_register_function", out)
 
-  def test_embind_asyncify(self):
+  @parameterized({
+    '': ([],),
+    'no_dynamic_execution': (['-s', 'DYNAMIC_EXECUTION=0'],),
+  })
+  def test_embind_asyncify(self, args):
     create_file('post.js', '''
       addOnPostRun(function() {
-        Module.sleep(10);
+        Module.sleep(10).then(function() {
+          return Module.sleep_and_sum(1, 2, 3, 4, 5, 6, 7, 8, 9);
+        }).then(function(sum) {
+          out('sum: ' + sum);
+        });
         out('done');
       });
     ''')
@@ -2335,12 +2381,18 @@ int f() {
       #include <emscripten.h>
       #include <emscripten/bind.h>
       using namespace emscripten;
+      // More arguments than embind has precompiled invokers for.
+      int sleep_and_sum(int a, int b, int c, int d, int e, int f, int g, int h, int i) {
+        emscripten_sleep(10);
+        return a + b + c + d + e + f + g + h + i;
+      }
       EMSCRIPTEN_BINDINGS(asyncify) {
           function("sleep", &emscripten_sleep);
+          function("sleep_and_sum", &sleep_and_sum);
       }
     ''')
-    self.run_process([EMXX, 'main.cpp', '--bind', '-s', 'ASYNCIFY', '--post-js', 'post.js'])
-    self.assertContained('done', self.run_js('a.out.js'))
+    self.run_process([EMXX, 'main.cpp', '--bind', '-s', 'ASYNCIFY', '--post-js', 'post.js'] + args)
+    self.assertContained('done\nsum: 45', self.run_js('a.out.js'))
 
   def test_embind_closure_no_dynamic_execution(self):
     create_file('post.js', '''
@@ -2375,6 +2427,9 @@ int f() {
         test_cases_without_utf8.append((args + without_utf8_args))
     test_cases += test_cases_without_utf8
     test_cases.extend([(args[:] + ['-s', 'DYNAMIC_EXECUTION=0']) for args in test_cases])
+    # the invokers wait for ASYNCIFY to finish before running the destructors
+    test_cases.append((['--bind', '-O2', '-s', 'ASYNCIFY']))
+    test_cases.append((['--bind', '-O2', '-s', 'ASYNCIFY', '-s', 'DYNAMIC_EXECUTION=0']))
     # closure compiler doesn't work with DYNAMIC_EXECUTION=0
     test_cases.append((['--bind', '-O2', '--closure=1']))
     for args in test_cases:
@@ -5844,6 +5899,76 @@ int main(int argc,char** argv) {
     self.set_setting('EXIT_RUNTIME')
     self.do_other_test('test_dlopen_async.c')
 
+  def test_dlclose_compiled_module(self):
+    # The compiled module is kept for new threads until the last dlclose.
+    create_file('side.c', 'int foo = 42;\n')
+    self.run_process([EMCC, 'side.c', '-o', 'libside.so', '-s', 'SIDE_MODULE'])
+    self.set_setting('MAIN_MODULE', 2)
+    self.set_setting('EXIT_RUNTIME')
+    self.do_other_test('test_dlclose_compiled_module.c')
+
+  def test_dylink_compile_concurrently(self):
+    # All the preloaded libraries are compiled before the first one is
+    # instantiated, and are still instantiated in order.
+    create_file('one.c', 'int one() { return 1; }\n')
+    create_file('two.c', 'int one(); int two() { return one() + 1; }\n')
+    create_file('three.c', 'int two(); int three() { return two() + 1; }\n')
+    for name in ('one', 'two', 'three'):
+      self.run_process([EMCC, name + '.c', '-o', 'lib%s.wasm' % name, '-s', 'SIDE_MODULE'])
+    create_file('pre.js', '''
+      var compiles = 0;
+      var compilesBeforeInstantiate = -1;
+      var origCompile = WebAssembly.compile;
+      WebAssembly.compile = function(bytes) {
+        compiles++;
+        return origCompile(bytes);
+      };
+      var origInstantiate = WebAssembly.instantiate;
+      WebAssembly.instantiate = function(module, imports) {
+        if (module instanceof WebAssembly.Module && compilesBeforeInstantiate < 0) {
+          compilesBeforeInstantiate = compiles;
+        }
+        return origInstantiate(module, imports);
+      };
+    ''')
+    create_file('main.c', r'''
+      #include <emscripten.h>
+      #include <stdio.h>
+      int three();
+      int main() {
+        printf("three: %d\n", three());
+        printf("compiled before instantiating: %d\n", EM_ASM_INT({ return compilesBeforeInstantiate; }));
+        return 0;
+      }
+    ''')
+    self.do_smart_test('main.c', ['three: 3', 'compiled before instantiating: 3'],
+                       emcc_args=['-s', 'MAIN_MODULE', '--pre-js', 'pre.js',
+                                  'libone.wasm', 'libtwo.wasm', 'libthree.wasm'])
+
+  def test_dylink_table_batch_duplicates(self):
+    # Exports that are the same function share a table slot, and the table is
+    # grown only for the slots that are used.
+    create_file('side.c', '''
+      void foo() {}
+      void bar() __attribute__((alias("foo")));
+    ''')
+    self.run_process([EMCC, 'side.c', '-o', 'libside.so', '-s', 'SIDE_MODULE'])
+    create_file('main.c', r'''
+      #include <assert.h>
+      #include <dlfcn.h>
+      #include <emscripten.h>
+      #include <stdio.h>
+      int main() {
+        void* handle = dlopen("libside.so", RTLD_NOW);
+        assert(handle);
+        assert(dlsym(handle, "foo") == dlsym(handle, "bar"));
+        printf("free table slots: %d\n", EM_ASM_INT({ return freeTableIndexes.length; }));
+        return 0;
+      }
+    ''')
+    self.do_smart_test('main.c', ['free table slots: 0'],
+                       emcc_args=['-s', 'MAIN_MODULE=2', '--embed-file', 'libside.so'])
+
   def test_dlopen_blocking(self):
     create_file('side.c', 'int foo = 42;\n')
     self.run_process([EMCC, 'side.c', '-o', 'libside.so', '-s', 'SIDE_MODULE'])
@@ -6728,6 +6853,80 @@ mergeInto(LibraryManager.library, {
       # TODO(sbc): Re-enable onece ctor evaluation is working with llvm backend.
       # self.assertContained('external_thing', err) # the failing call should be mentioned
 
+  def test_heap_snapshot(self):
+    create_file('src.cpp', r'''
+      #include <stdio.h>
+      #include <stdlib.h>
+      #include <emscripten.h>
+
+      struct Counter {
+        int count = 0;
+        Counter() { count++; }
+      };
+      Counter counter;
+
+      int* table;
+
+      void init() {
+        printf("initializing\n");
+        table = (int*)malloc(1000 * sizeof(int));
+        for (int i = 0; i < 1000; i++) {
+          table[i] = i * i;
+        }
+        emscripten_snapshot_point();
+      }
+
+      int main() {
+        if (!emscripten_snapshot_restored()) {
+          init();
+        }
+        printf("restored: %d ctors: %d table: %d\n", emscripten_snapshot_restored(), counter.count, table[999]);
+        return 0;
+      }
+    ''')
+    self.run_process([EMXX, 'src.cpp'])
+    self.assertContained('initializing\nrestored: 0 ctors: 1 table: 998001\n', self.run_js('a.out.js'))
+    size = os.path.getsize('a.out.wasm')
+
+    self.run_process([EMXX, 'src.cpp', '-s', 'HEAP_SNAPSHOT'])
+    output = self.run_js('a.out.js')
+    self.assertNotContained('initializing', output)
+    self.assertContained('restored: 1 ctors: 1 table: 998001\n', output)
+    # the table computed during initialization is now part of the binary
+    self.assertGreater(os.path.getsize('a.out.wasm'), size + 1000)
+
+    # without a snapshot point the binary is left as it is
+    create_file('nosnapshot.c', 'int main() { return 0; }')
+    err = self.run_process([EMCC, 'nosnapshot.c', '-s', 'HEAP_SNAPSHOT'], stderr=PIPE).stderr
+    self.assertContained('no snapshot taken', err)
+
+    err = self.expect_fail([EMXX, 'src.cpp', '-s', 'HEAP_SNAPSHOT', '-s', 'ALLOW_TABLE_GROWTH'])
+    self.assertContained('HEAP_SNAPSHOT cannot capture functions added to the table at runtime', err)
+
+    # constructors that call into JS would lose that work when they are skipped
+    create_file('jsctor.cpp', r'''
+      #include <stdio.h>
+      #include <emscripten.h>
+
+      EM_JS(void, register_in_js, (), {
+        Module['registered'] = true;
+      });
+
+      struct Registrar {
+        Registrar() { register_in_js(); }
+      };
+      Registrar registrar;
+
+      int main() {
+        emscripten_snapshot_point();
+        return 0;
+      }
+    ''')
+    err = self.expect_fail([EMXX, 'jsctor.cpp', '-s', 'HEAP_SNAPSHOT'])
+    self.assertContained('HEAP_SNAPSHOT: global constructors called JS imports, whose effects cannot be part of the snapshot: register_in_js', err)
+    err = self.expect_fail([EMXX, 'src.cpp', '-s', 'HEAP_SNAPSHOT', '--bind'])
+    self.assertContained('HEAP_SNAPSHOT is not compatible with embind', err)
+
   def test_override_js_execution_environment(self):
     create_file('main.cpp', r'''
       #include <emscripten.h>
@@ -7894,6 +8093,84 @@ end
     create_file(externs, '')
     self.run_process([EMCC, test, '--closure=1', '--closure-args', '--externs "' + externs + '"'])
 
+  def test_js_pass_cache(self):
+    self.run_process([EMCC, test_file('hello_world.c'), '-O2', '--closure=1'])
+    expected = read_file('a.out.js')
+    # Relinking reuses the outputs of the JS passes from the first link
+    with env_modify({'EMCC_DEBUG': '1'}):
+      err = self.run_process([EMCC, test_file('hello_world.c'), '-O2', '--closure=1'], stderr=PIPE).stderr
+    self.assertContained('acorn: using cached output', err)
+    self.assertContained('closure: using cached output', err)
+    self.assertEqual(read_file('a.out.js'), expected)
+    self.assertContained('hello, world!', self.run_js('a.out.js'))
+    # Unless the cache is disabled
+    with env_modify({'EMCC_DEBUG': '1', 'EMCC_JS_PASS_CACHE_SIZE': '0'}):
+      err = self.run_process([EMCC, test_file('hello_world.c'), '-O2', '--closure=1'], stderr=PIPE).stderr
+    self.assertNotContained('using cached output', err)
+
+  def test_incremental_link(self):
+    create_file('lib.js', 'mergeInto(LibraryManager.library, { foo: function() { out("foo 1"); } });')
+    create_file('main.c', 'void foo(void); int main() { foo(); return 0; }')
+    self.run_process([EMCC, '-c', 'main.c'])
+
+    def link():
+      with env_modify({'EMCC_DEBUG': '1'}):
+        return self.run_process([EMCC, 'main.o', '--js-library', 'lib.js', '-sINCREMENTAL_LINK'], stderr=PIPE).stderr
+
+    link()
+    self.assertExists('a.out.linkstate')
+    self.assertContained('foo 1', self.run_js('a.out.js'))
+
+    # Nothing changed, so neither wasm-ld nor the JS compiler run again
+    err = link()
+    self.assertContained('reusing the previous wasm-ld output', err)
+    self.assertContained('JS compiler inputs are unchanged', err)
+    self.assertContained('foo 1', self.run_js('a.out.js'))
+
+    # A change to a JS library only runs the JS compiler again
+    create_file('lib.js', 'mergeInto(LibraryManager.library, { foo: function() { out("foo 2"); } });')
+    err = link()
+    self.assertContained('reusing the previous wasm-ld output', err)
+    self.assertNotContained('JS compiler inputs are unchanged', err)
+    self.assertContained('foo 2', self.run_js('a.out.js'))
+
+    # A change to native code only runs wasm-ld again
+    create_file('main.c', 'void foo(void); int main() { foo(); foo(); return 0; }')
+    self.run_process([EMCC, '-c', 'main.c'])
+    err = link()
+    self.assertNotContained('reusing the previous wasm-ld output', err)
+    self.assertContained('JS compiler inputs are unchanged', err)
+    self.assertContained('foo 2\nfoo 2', self.run_js('a.out.js'))
+
+  def test_js_library_cache(self):
+    create_file('lib.js', '''
+mergeInto(LibraryManager.library, {
+  get_value: function() {
+#if ASSERTIONS
+    return 1;
+#else
+    return {{{ 1 + 1 }}};
+#endif
+  },
+});
+''')
+    create_file('main.c', r'''
+      #include <stdio.h>
+      int get_value(void);
+      int main() {
+        printf("value: %d\n", get_value());
+        return 0;
+      }
+    ''')
+    cached = 'using cached preprocessed source for ' + os.path.abspath('lib.js')
+    self.run_process([EMCC, 'main.c', '--js-library', 'lib.js'])
+    err = self.run_process([EMCC, 'main.c', '--js-library', 'lib.js', '-sVERBOSE'], stderr=PIPE).stderr
+    self.assertContained(cached, err)
+    self.assertContained('value: 2', self.run_js('a.out.js'))
+    # The cached copy is not used after a change to a setting that it depends on
+    self.run_process([EMCC, 'main.c', '--js-library', 'lib.js', '-sASSERTIONS'])
+    self.assertContained('value: 1', self.run_js('a.out.js'))
+
   def test_toolchain_profiler(self):
     # Verify some basic functionality of EMPROFILE
     environ = os.environ.copy()
@@ -7955,6 +8232,17 @@ end
     self.assertEqual(read_binary(get_cached()).count(b'waka'), 0)
     self.assertNotContained(ERROR, self.run_js('a.out.js'))
 
+  def test_wasm_module_cache_hash(self):
+    self.run_process([EMCC, test_file('hello_world.c'), '-s', 'WASM_MODULE_CACHE'])
+    # the cache key is the hash of the final wasm binary
+    wasm_hash = hashlib.sha256(read_binary('a.out.wasm')).hexdigest()
+    self.assertContained(wasm_hash, read_file('a.out.js'))
+    self.assertNotContained('WASM_BINARY_HASH', read_file('a.out.js'))
+    self.assertContained('hello, world!', self.run_js('a.out.js'))
+
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-s', 'WASM_MODULE_CACHE', '-s', 'WASM_ASYNC_COMPILATION=0'])
+    self.assertContained('WASM_MODULE_CACHE requires async compilation', err)
+
   def test_autotools_shared_check(self):
     env = os.environ.copy()
     env['LC_ALL'] = 'C'
@@ -10005,6 +10293,10 @@ Aborted(Module.arguments has been replaced with plain arguments_ (the initial va
     output = self.run_process([os.path.abspath('program.exe')], stdout=PIPE).stdout
     self.assertEqual(output, read_file(test_file('other/wasm2c/output-multi.txt')))
 
+  def test_wasm2c_pthreads(self):
+    err = self.expect_fail([EMCC, test_file('hello_world.c'), '-s', 'WASM2C', '-pthread'])
+    self.assertContained('WASM2C does not support pthreads', err)
+
   @parameterized({
     'wasm2js': (['-s', 'WASM=0'], ''),
     'modularize': (['-s', 'MODULARIZE'], 'Module()'),
@@ -10527,6 +10819,27 @@ exec "$@"
     # TODO: Enable '-s', 'CLOSURE_WARNINGS=error' in the following, but that has currently regressed.
     self.run_process([EMCC, test_file('hello_world.c'), '-O2', '-s', 'USE_PTHREADS', '--closure=1', '--threadprofiler'])
 
+  @node_pthreads
+  def test_threadprofiler_report(self):
+    self.run_process([EMCC, test_file('other/test_threadprofiler_report.c'), '-sUSE_PTHREADS', '-sPTHREAD_POOL_SIZE=4', '-sEXIT_RUNTIME', '--threadprofiler'])
+    with env_modify({'EMSCRIPTEN_THREADPROFILER_REPORT': 'profile.json'}):
+      output = self.run_js('a.out.js')
+    self.assertContained('counter: 80', output)
+    mutex, mutex_size = [int(x) for x in output.split('mutex: ')[1].split()]
+
+    report = json.loads(read_file('profile.json'))
+    # The main thread and the four workers, which have all exited.
+    self.assertEqual(len(report['threads']), 5)
+    for thread in report['threads']:
+      self.assertIn('running', thread['timeInStatus'])
+    # The workers spent their time blocked on the mutex, which should be the
+    # most contended futex.
+    top = report['futexes'][0]
+    self.assertGreaterEqual(top['address'], mutex)
+    self.assertLess(top['address'], mutex + mutex_size)
+    self.assertGreater(top['waits'], 0)
+    self.assertGreater(top['waitTime'], 0)
+
   def test_syslog(self):
     self.do_other_test('test_syslog.c')
 
@@ -705,6 +705,20 @@ fi
     # Unless --force is specified
     self.assertContained('generating system library', self.do([EMBUILDER, 'build', 'libemmalloc', '--force']))
 
+  def test_embuilder_object_cache(self):
+    restore_and_set_up()
+    self.clear_cache()
+    self.do([EMBUILDER, 'build', 'libemmalloc'])
+    # Rebuilding reuses the objects that were compiled the first time
+    output = self.do([EMBUILDER, 'build', 'libemmalloc', '--force'])
+    self.assertContained('generating system library', output)
+    self.assertContained('reusing 2 of 2 objects from the object cache', output)
+    # Building several libraries at once builds all of them
+    self.do([EMBUILDER, 'build', 'libdlmalloc', 'libemmalloc-debug', 'libstubs'])
+    self.assertExists(os.path.join(config.CACHE, Cache.get_lib_name('libdlmalloc.a')))
+    self.assertExists(os.path.join(config.CACHE, Cache.get_lib_name('libemmalloc-debug.a')))
+    self.assertExists(os.path.join(config.CACHE, Cache.get_lib_name('libstubs.a')))
+
   def test_embuilder_force_port(self):
     restore_and_set_up()
     self.do([EMBUILDER, 'build', 'zlib'])
@@ -355,6 +355,22 @@ class sockets(BrowserCore):
           self.assertContained('do_msg_read: read 14 bytes', out)
           self.assertContained('connect: ws://localhost:59168/testA/testB, text,base64,binary', out)
 
+  # Throughput benchmark of many small stream socket sends/recvs from a Node.js client, with and
+  # without SOCKET_COALESCE_SENDS.
+  def test_nodejs_sockets_echo_throughput(self):
+    if config.NODE_JS not in config.JS_ENGINES:
+      self.skipTest('node is not present')
+
+    sockets_include = '-I' + test_file('sockets')
+
+    for i, args in enumerate([[], ['-s', 'SOCKET_COALESCE_SENDS']]):
+      port = 59170 + i
+      with CompiledServerHarness(os.path.join('sockets', 'test_sockets_echo_server.c'), [sockets_include, '-DTEST_DGRAM=0'] + args, port):
+        self.run_process([EMCC, '-Werror', '-O2', test_file('sockets', 'test_sockets_echo_throughput_client.c'), '-o', 'client.js', '-DSOCKK=%d' % port] + args)
+        out = self.run_js('client.js')
+        print(args, out.strip())
+        self.assertContained('echoed 4194304 bytes', out)
+
   # Test Emscripten WebSockets API to send and receive text and binary messages against an echo server.
   # N.B. running this test requires 'npm install ws' in Emscripten root directory
   def test_websocket_send(self):
@@ -375,3 +391,5 @@ class sockets(BrowserCore):
       with PythonTcpEchoServerProcess('7777'):
         # Build and run the TCP echo client program with Emscripten
         self.btest(test_file('websocket', 'tcp_echo_client.cpp'), expected='101', args=['-lwebsocket', '-s', 'PROXY_POSIX_SOCKETS', '-s', 'USE_PTHREADS', '-s', 'PROXY_TO_PTHREAD'])
+        # Test sendmsg()/recvmsg(), batched poll and pipelined sends over the bridge
+        self.btest(test_file('websocket', 'tcp_echo_client.cpp'), expected='101', args=['-lwebsocket', '-s', 'PROXY_POSIX_SOCKETS', '-s', 'USE_PTHREADS', '-s', 'PROXY_TO_PTHREAD', '-DTEST_SENDMSG_AND_POLL'])
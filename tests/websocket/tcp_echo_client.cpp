@@ -11,12 +11,9 @@
 #include <emscripten.h>
 #include <emscripten/websocket.h>
 #include <emscripten/threading.h>
+#include <emscripten/posix_socket.h>
  
 EMSCRIPTEN_WEBSOCKET_T bridgeSocket = 0;
-
-extern "C" {
-EMSCRIPTEN_WEBSOCKET_T emscripten_init_websocket_to_posix_socket_bridge(const char *bridgeUrl);
-}
 #endif
 
 int lookup_host(const char *host)
@@ -70,6 +67,10 @@ int main(int argc , char *argv[])
     emscripten_websocket_get_ready_state(bridgeSocket, &readyState);
     emscripten_thread_sleep(100);
   } while(readyState == 0);
+
+#ifdef TEST_SENDMSG_AND_POLL
+  emscripten_websocket_to_posix_socket_bridge_set_pipelined_sends(EM_TRUE);
+#endif
 #endif
 
   lookup_host("google.com");
@@ -97,6 +98,37 @@ int main(int argc , char *argv[])
   puts("Connected\n");
   for(int i = 0; i < 10; ++i)
   {
+#ifdef TEST_SENDMSG_AND_POLL
+    char part1[] = "he";
+    char part2[] = "ll";
+    struct iovec send_iov[2] = { { part1, 2 }, { part2, 2 } };
+    struct msghdr send_msg = {};
+    send_msg.msg_iov = send_iov;
+    send_msg.msg_iovlen = 2;
+    if (sendmsg(sock, &send_msg, 0) != 4)
+    {
+      puts("sendmsg failed");
+      return 1;
+    }
+
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    if (emscripten_websocket_to_posix_socket_bridge_poll(&pfd, 1, 5000) != 1 || !(pfd.revents & POLLIN))
+    {
+      puts("poll failed");
+      return 1;
+    }
+
+    char server_reply[256] = {};
+    struct iovec recv_iov[2] = { { server_reply, 1 }, { server_reply + 1, 255 } };
+    struct msghdr recv_msg = {};
+    recv_msg.msg_iov = recv_iov;
+    recv_msg.msg_iovlen = 2;
+    if (recvmsg(sock, &recv_msg, 0) < 0)
+    {
+      puts("recvmsg failed");
+      break;
+    }
+#else
     const char message[] = "hell";
     if (send(sock, message, strlen(message), 0) < 0)
     {
@@ -110,6 +142,7 @@ int main(int argc , char *argv[])
       puts("recv failed");
       break;
     }
+#endif
      
     puts("Server reply: ");
     puts(server_reply);
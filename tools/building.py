@@ -5,6 +5,7 @@
 
 from .toolchain_profiler import ToolchainProfiler
 
+import hashlib
 import json
 import logging
 import os
@@ -14,6 +15,7 @@ import shutil
 import subprocess
 import sys
 import tempfile
+import threading
 from subprocess import PIPE
 
 from . import diagnostics
@@ -357,7 +359,44 @@ def lld_flags_for_executable(external_symbols):
   return cmd
 
 
-def link_lld(args, target, external_symbols=None):
+def get_link_key(cmd):
+  """
+  Returns a key that identifies a wasm-ld command line along with the state of
+  the input files it names, for INCREMENTAL_LINK.  Files are identified by their
+  size and modification time, except for temporary files, which get new names
+  on each link and so are identified by their contents.
+  """
+  tmpdir = os.path.join(os.path.abspath(configuration.get_temp_files().tmpdir), '')
+
+  def identify(path):
+    path = os.path.abspath(path)
+    if path.startswith(tmpdir):
+      return hashlib.sha256(utils.read_binary(path)).hexdigest()
+    stat = os.stat(path)
+    return [path, stat.st_size, stat.st_mtime_ns]
+
+  key = [shared.EMSCRIPTEN_VERSION, os.getcwd(), identify(cmd[0])]
+  for i, arg in enumerate(cmd[1:], 1):
+    if cmd[i - 1] == '-o':
+      key.append('<output>')
+    elif arg.startswith('-L') and os.path.isdir(arg[2:]):
+      # Libraries are found in the search path by name.
+      libdir = arg[2:]
+      files = sorted(f for f in os.listdir(libdir) if os.path.isfile(os.path.join(libdir, f)))
+      key.append([arg, [identify(os.path.join(libdir, f)) for f in files]])
+    elif arg.startswith('@') and os.path.isfile(arg[1:]):
+      key.append(['@', identify(arg[1:])])
+    elif arg.startswith('-') and '=' in arg and os.path.isfile(arg.split('=', 1)[1]):
+      name, path = arg.split('=', 1)
+      key.append([name, identify(path)])
+    elif os.path.isfile(arg):
+      key.append(identify(arg))
+    else:
+      key.append(arg)
+  return hashlib.sha256(json.dumps(key).encode()).hexdigest()
+
+
+def link_lld(args, target, external_symbols=None, link_state_dir=None):
   if not os.path.exists(WASM_LD):
     exit_with_error('linker binary not found in LLVM directory: %s', WASM_LD)
   # runs lld to link things.
@@ -389,8 +428,23 @@ def link_lld(args, target, external_symbols=None):
   if '--relocatable' not in args and '-r' not in args:
     cmd += lld_flags_for_executable(external_symbols)
 
-  cmd = get_command_with_possible_response_file(cmd)
-  check_call(cmd)
+  if not link_state_dir:
+    check_call(get_command_with_possible_response_file(cmd))
+    return
+
+  # In incremental links, reuse the output of the previous link if nothing that
+  # goes into it has changed.
+  key = get_link_key(cmd)
+  key_file = os.path.join(link_state_dir, 'wasm-ld.key')
+  saved_output = os.path.join(link_state_dir, 'wasm-ld.wasm')
+  if os.path.exists(key_file) and utils.read_file(key_file) == key and os.path.exists(saved_output):
+    logger.debug('incremental link: linker inputs are unchanged, reusing the previous wasm-ld output')
+    shutil.copyfile(saved_output, target)
+    return
+  try_delete(key_file)
+  check_call(get_command_with_possible_response_file(cmd))
+  shutil.copyfile(target, saved_output)
+  utils.write_file(key_file, key)
 
 
 def link_bitcode(args, target, force_archive_contents=False):
@@ -617,12 +671,104 @@ def js_optimizer(filename, passes):
     exit_with_error("'%s' failed (%d)", ' '.join(e.cmd), e.returncode)
 
 
+# The outputs of the JS passes (acorn-optimizer.js passes and closure) are
+# cached by the contents of their inputs, so that relinking after a change that
+# doesn't affect the JS, e.g. one in C++ code, reuses them rather than running
+# the passes again.  The cache is kept to EMCC_JS_PASS_CACHE_SIZE megabytes by
+# removing the least recently used outputs, and setting it to 0 disables it.
+JS_PASS_CACHE_SIZE = int(os.environ.get('EMCC_JS_PASS_CACHE_SIZE', '256')) * 1024 * 1024
+
+
+def get_js_pass_cache_dir():
+  if not JS_PASS_CACHE_SIZE or config.FROZEN_CACHE:
+    return None
+  return shared.Cache.get_path('js_passes')
+
+
+def prune_js_pass_cache(cache_dir):
+  entries = []
+  for entry in os.scandir(cache_dir):
+    try:
+      stat = entry.stat()
+    except OSError:
+      continue
+    entries.append((stat.st_mtime, stat.st_size, entry.path))
+  total_size = sum(size for _, size, _ in entries)
+  for _, size, path in sorted(entries):
+    if total_size <= JS_PASS_CACHE_SIZE:
+      break
+    try_delete(path)
+    total_size -= size
+
+
+def run_cached_js_pass(name, args, inputs, outputs, run):
+  """
+  Runs a pass that reads the `inputs` files and writes the `outputs` files,
+  unless the JS pass cache has the outputs of an earlier run of the same pass
+  with the same `args`, on inputs with the same contents.  In that case the
+  outputs are copied from the cache instead.  `run` returns whether its outputs
+  can be cached.
+  """
+  cache_dir = get_js_pass_cache_dir()
+  if not cache_dir:
+    run()
+    return
+  key = hashlib.sha256(json.dumps([shared.EMSCRIPTEN_VERSION, name, args]).encode())
+  for filename in inputs:
+    key.update(utils.read_binary(filename))
+  key = key.hexdigest()
+  cached = [os.path.join(cache_dir, f'{key}.{i}') for i in range(len(outputs))]
+  try:
+    for cached_output, output in zip(cached, outputs):
+      shutil.copyfile(cached_output, output)
+      os.utime(cached_output)
+    logger.debug(f'{name}: using cached output')
+    return
+  except OSError:
+    # Not in the cache, or removed from it while we were copying.
+    pass
+  if not run():
+    return
+  utils.safe_ensure_dirs(cache_dir)
+  for cached_output, output in zip(cached, outputs):
+    temp = f'{cached_output}.{os.getpid()}.{threading.get_ident()}.tmp'
+    shutil.copyfile(output, temp)
+    os.replace(temp, cached_output)
+  prune_js_pass_cache(cache_dir)
+
+
+class BackgroundTask:
+  """
+  Runs a function on another thread, for passes that don't depend on each other
+  and spend their time waiting on a subprocess.  Any exception it raises
+  (including the SystemExit from exit_with_error) is re-raised by wait().
+  """
+
+  def __init__(self, func, *args):
+    self.result = None
+    self.error = None
+    self.thread = threading.Thread(target=self.run, args=(func, args))
+    self.thread.start()
+
+  def run(self, func, args):
+    try:
+      self.result = func(*args)
+    except BaseException as e:
+      self.error = e
+
+  def wait(self):
+    self.thread.join()
+    if self.error:
+      raise self.error
+    return self.result
+
+
 # run JS optimizer on some JS, ignoring asm.js contents if any - just run on it all
 def acorn_optimizer(filename, passes, extra_info=None, return_output=False):
   optimizer = path_from_root('tools/acorn-optimizer.js')
   original_filename = filename
+  temp_files = configuration.get_temp_files()
   if extra_info is not None:
-    temp_files = configuration.get_temp_files()
     temp = temp_files.get('.js').name
     shutil.copyfile(filename, temp)
     with open(temp, 'a') as f:
@@ -637,14 +783,22 @@ def acorn_optimizer(filename, passes, extra_info=None, return_output=False):
     cmd += ['--exportES6']
   if settings.VERBOSE:
     cmd += ['verbose']
-  if not return_output:
+  if return_output:
+    next = temp_files.get('.js').name
+  else:
     next = original_filename + '.jso.js'
-    configuration.get_temp_files().note(next)
-    check_call(cmd, stdout=open(next, 'w'))
-    save_intermediate(next, '%s.js' % passes[0])
-    return next
-  output = check_call(cmd, stdout=PIPE).stdout
-  return output
+    temp_files.note(next)
+
+  def run():
+    with open(next, 'w') as f:
+      check_call(cmd, stdout=f)
+    return True
+
+  run_cached_js_pass('acorn', cmd[len(config.NODE_JS) + 2:], [optimizer, filename], [next], run)
+  if return_output:
+    return utils.read_file(next)
+  save_intermediate(next, '%s.js' % passes[0])
+  return next
 
 
 # evals ctors. if binaryen_bin is provided, it is the dir of the binaryen tool
@@ -659,6 +813,50 @@ def eval_ctors(js_file, binary_file, debug_info=False): # noqa
   # check_call(cmd)
 
 
+# Runs of at least this many zero bytes split the heap snapshot into separate
+# data segments; shorter runs are cheaper to keep than another segment header.
+SNAPSHOT_SEGMENT_GAP = 64
+
+
+def take_heap_snapshot(js_file, wasm_file):
+  """Runs the program until it calls emscripten_snapshot_point(), and replaces
+  the data segments of the wasm file with the contents of memory at that
+  point."""
+  logger.debug('taking heap snapshot')
+  snapshot_file = wasm_file + '.snapshot'
+  # The JS looks for the wasm binary in its own directory, so run a copy of it
+  # from alongside the wasm.
+  snapshot_js = wasm_file + '.snapshot.js'
+  shutil.copyfile(js_file, snapshot_js)
+  env = os.environ.copy()
+  env['EMCC_HEAP_SNAPSHOT_FILE'] = snapshot_file
+  try:
+    proc = run_process(config.NODE_JS + [snapshot_js], env=env, stdout=PIPE, check=False)
+  finally:
+    try_delete(snapshot_js)
+  if not os.path.exists(snapshot_file):
+    if proc.returncode:
+      exit_with_error('HEAP_SNAPSHOT: program failed before a snapshot could be taken')
+    diagnostics.warning('emcc', 'HEAP_SNAPSHOT: program exited without calling emscripten_snapshot_point(), no snapshot taken')
+    return
+
+  heap = utils.read_binary(snapshot_file)
+  try_delete(snapshot_file)
+  if len(heap) > settings.INITIAL_MEMORY:
+    exit_with_error('HEAP_SNAPSHOT: memory grew to %d bytes before the snapshot point; set INITIAL_MEMORY to at least that' % len(heap))
+
+  segments = []
+  start = 0
+  for gap in re.finditer(b'\0{%d,}' % SNAPSHOT_SEGMENT_GAP, heap):
+    if gap.start() > start:
+      segments.append((start, heap[start:gap.start()]))
+    start = gap.end()
+  if start < len(heap):
+    segments.append((start, heap[start:].rstrip(b'\0')))
+  logger.debug('heap snapshot: %d bytes in %d segments' % (sum(len(s) for _, s in segments), len(segments)))
+  webassembly.replace_data_segments(wasm_file, segments)
+
+
 def get_closure_compiler():
   # First check if the user configured a specific CLOSURE_COMPILER in thier settings
   if config.CLOSURE_COMPILER:
@@ -825,45 +1023,68 @@ def closure_compiler(filename, pretty, advanced=True, extra_closure_args=None):
   # 7-bit ASCII range. Therefore make sure the command line we pass does not contain any such
   # input files by passing all input filenames relative to the cwd. (user temp directory might
   # be in user's home directory, and user's profile name might contain unicode characters)
-  proc = run_process(cmd, stderr=PIPE, check=False, env=env, cwd=tempfiles.tmpdir)
-
-  # XXX Closure bug: if Closure is invoked with --create_source_map, Closure should create a
-  # outfile.map source map file (https://github.com/google/closure-compiler/wiki/Source-Maps)
-  # But it looks like it creates such files on Linux(?) even without setting that command line
-  # flag (and currently we don't), so delete the produced source map file to not leak files in
-  # temp directory.
-  try_delete(outfile + '.map')
+  # For the JS pass cache, use the contents of the files closure reads rather
+  # than their (temporary) names.
+  cache_args = []
+  cache_inputs = []
+  for i, arg in enumerate(cmd):
+    if i and cmd[i - 1] in ('--externs', '--js'):
+      cache_args.append('<input>')
+      cache_inputs.append(os.path.join(tempfiles.tmpdir, arg))
+    elif i and cmd[i - 1] == '--js_output_file':
+      cache_args.append('<output>')
+    else:
+      cache_args.append(arg)
+  stderr_file = tempfiles.get('.cc.stderr').name
+  returncode = 0
+
+  def run():
+    nonlocal returncode
+    proc = run_process(cmd, stderr=PIPE, check=False, env=env, cwd=tempfiles.tmpdir)
+    returncode = proc.returncode
+    utils.write_file(stderr_file, proc.stderr)
+
+    # XXX Closure bug: if Closure is invoked with --create_source_map, Closure should create a
+    # outfile.map source map file (https://github.com/google/closure-compiler/wiki/Source-Maps)
+    # But it looks like it creates such files on Linux(?) even without setting that command line
+    # flag (and currently we don't), so delete the produced source map file to not leak files in
+    # temp directory.
+    try_delete(outfile + '.map')
+    return returncode == 0
+
+  run_cached_js_pass('closure', cache_args, cache_inputs, [outfile, stderr_file], run)
+  stderr = utils.read_file(stderr_file)
 
   # Print Closure diagnostics result up front.
-  if proc.returncode != 0:
+  if returncode != 0:
     logger.error('Closure compiler run failed:\n')
-  elif len(proc.stderr.strip()) > 0:
+  elif len(stderr.strip()) > 0:
     if settings.CLOSURE_WARNINGS == 'error':
       logger.error('Closure compiler completed with warnings and -s CLOSURE_WARNINGS=error enabled, aborting!\n')
     elif settings.CLOSURE_WARNINGS == 'warn':
       logger.warn('Closure compiler completed with warnings:\n')
 
   # Print input file (long wall of text!)
-  if DEBUG == 2 and (proc.returncode != 0 or (len(proc.stderr.strip()) > 0 and settings.CLOSURE_WARNINGS != 'quiet')):
+  if DEBUG == 2 and (returncode != 0 or (len(stderr.strip()) > 0 and settings.CLOSURE_WARNINGS != 'quiet')):
     input_file = open(filename, 'r').read().splitlines()
     for i in range(len(input_file)):
       sys.stderr.write(f'{i + 1}: {input_file[i]}\n')
 
-  if proc.returncode != 0:
-    logger.error(proc.stderr) # print list of errors (possibly long wall of text if input was minified)
+  if returncode != 0:
+    logger.error(stderr) # print list of errors (possibly long wall of text if input was minified)
 
     # Exit and print final hint to get clearer output
-    msg = f'closure compiler failed (rc: {proc.returncode}): {shared.shlex_join(cmd)}'
+    msg = f'closure compiler failed (rc: {returncode}): {shared.shlex_join(cmd)}'
     if not pretty:
       msg += ' the error message may be clearer with -g1 and EMCC_DEBUG=2 set'
     exit_with_error(msg)
 
-  if len(proc.stderr.strip()) > 0 and settings.CLOSURE_WARNINGS != 'quiet':
+  if len(stderr.strip()) > 0 and settings.CLOSURE_WARNINGS != 'quiet':
     # print list of warnings (possibly long wall of text if input was minified)
     if settings.CLOSURE_WARNINGS == 'error':
-      logger.error(proc.stderr)
+      logger.error(stderr)
     else:
-      logger.warn(proc.stderr)
+      logger.warn(stderr)
 
     # Exit and/or print final hint to get clearer output
     if not pretty:
@@ -139,8 +139,13 @@ class Cache:
     return self.get(name, *args, **kwargs)
 
   # Request a cached file. If it isn't in the cache, it will be created with
-  # the given creator function
-  def get(self, shortname, creator, what=None, force=False):
+  # the given creator function.
+  # If atomic is set, the file is created under a temporary name and then
+  # renamed into place, rather than while holding the cache lock.  Readers never
+  # see a partially written file, and concurrent processes can create different
+  # files at the same time.  If two processes create the same file, one of them
+  # replaces the other's (identical) copy.
+  def get(self, shortname, creator, what=None, force=False, atomic=False):
     cachename = os.path.join(self.dirname, shortname)
     cachename = os.path.abspath(cachename)
     # Check for existence before taking the lock in case we can avoid the
@@ -153,19 +158,37 @@ class Cache:
       # should never happen
       raise Exception(f'FROZEN_CACHE is set, but cache file is missing: "{shortname}" (in cache root path "{self.dirname}")')
 
+    if atomic:
+      self.create(shortname, cachename, creator, what, atomic=True)
+      return cachename
+
     with self.lock():
       if os.path.exists(cachename) and not force:
         return cachename
-      if what is None:
-        if shortname.endswith(('.bc', '.so', '.a')):
-          what = 'system library'
-        else:
-          what = 'system asset'
-      message = f'generating {what}: {shortname}... (this will be cached in "{cachename}" for subsequent builds)'
-      logger.info(message)
-      utils.safe_ensure_dirs(os.path.dirname(cachename))
-      creator(cachename)
-      assert os.path.exists(cachename)
-      logger.info(' - ok')
+      self.create(shortname, cachename, creator, what)
 
     return cachename
+
+  def create(self, shortname, cachename, creator, what, atomic=False):
+    if what is None:
+      if shortname.endswith(('.bc', '.so', '.a')):
+        what = 'system library'
+      else:
+        what = 'system asset'
+    message = f'generating {what}: {shortname}... (this will be cached in "{cachename}" for subsequent builds)'
+    logger.info(message)
+    utils.safe_ensure_dirs(os.path.dirname(cachename))
+    if atomic:
+      # Keep the extension, as creators such as system_libs.create_lib use it
+      # to decide what kind of file to write.
+      root, ext = os.path.splitext(cachename)
+      tempname = f'{root}.{os.getpid()}.tmp{ext}'
+      try:
+        creator(tempname)
+        os.replace(tempname, cachename)
+      finally:
+        tempfiles.try_delete(tempname)
+    else:
+      creator(cachename)
+    assert os.path.exists(cachename)
+    logger.info(' - ok')
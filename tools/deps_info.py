@@ -140,6 +140,7 @@ _deps_info = {
   'emscripten_set_touchstart_callback_on_thread': ['malloc', 'free'],
   'emscripten_set_visibilitychange_callback_on_thread': ['malloc', 'free'],
   'emscripten_set_wheel_callback_on_thread': ['malloc', 'free'],
+  'emscripten_snapshot_point': ['emscripten_stack_get_base', 'emscripten_stack_get_end'],
   'emscripten_webgl_create_context': ['malloc'],
   'emscripten_webgl_destroy_context': ['emscripten_webgl_make_context_current', 'emscripten_webgl_get_current_context'],
   'emscripten_webgl_get_parameter_utf8': ['malloc'],
@@ -218,4 +219,9 @@ def get_deps_info():
   if settings.USE_PTHREADS:
     _deps_info['emscripten_set_canvas_element_size_calling_thread'] = ['_emscripten_call_on_thread']
     _deps_info['emscripten_set_offscreencanvas_size_on_target_thread'] = ['_emscripten_call_on_thread', 'malloc', 'free']
+    # Events for these callbacks are sent to their threads through event rings.
+    for event in ['keydown', 'keypress', 'keyup', 'click', 'dblclick', 'mousedown', 'mouseenter',
+                  'mouseleave', 'mousemove', 'mouseout', 'mouseover', 'mouseup', 'wheel', 'resize',
+                  'scroll']:
+      _deps_info['emscripten_set_%s_callback_on_thread' % event] = ['malloc', 'free', '_emscripten_call_on_thread', '_emscripten_html5_event_ring_create', '_emscripten_html5_event_ring_queue_drain']
   return _deps_info
@@ -5,14 +5,18 @@
 
 from .toolchain_profiler import ToolchainProfiler
 
+import hashlib
 import itertools
+import json
 import logging
 import os
+import re
 import shutil
+import tempfile
 from enum import IntEnum, auto
 from glob import iglob
 
-from . import shared, building, utils
+from . import shared, building, utils, config
 from . import deps_info, tempfiles
 from . import diagnostics
 from tools.shared import mangle_c_symbol_name, demangle_c_symbol_name
@@ -72,6 +76,114 @@ def run_build_commands(commands):
   shared.run_multiple_processes(commands, env=clean_env())
 
 
+# Compiled objects are kept in a content-addressed object cache, so that
+# rebuilding a library (for example after editing one of its source files, or
+# with `embuilder build --force`) only recompiles the objects whose inputs
+# changed.  An object is looked up by a key made from its compile command and
+# the contents of its source file.  That leads to a manifest listing the headers
+# the source included last time (taken from the depfile the compiler writes),
+# with their hashes, and the object itself is stored under a name derived from
+# those as well.  Entries are written under a temporary name and renamed into
+# place, so concurrent builds never see a partial entry and don't need to hold
+# the cache lock.  The object cache is removed along with the rest of the cache
+# by `emcc --clear-cache`.
+_file_hashes = {}
+
+
+def hash_file(filename):
+  if filename not in _file_hashes:
+    _file_hashes[filename] = hashlib.sha256(utils.read_binary(filename)).hexdigest()
+  return _file_hashes[filename]
+
+
+def parse_depfile(filename):
+  """Returns the dependencies listed in a Makefile-style depfile written by `-MD`."""
+  deps = utils.read_file(filename).replace('\\\n', ' ').split(': ', 1)[1]
+  return [d.replace('\\ ', ' ') for d in re.split(r'(?<!\\)\s+', deps) if d]
+
+
+def replace_atomically(filename, write):
+  tempname = f'{filename}.{os.getpid()}.tmp'
+  try:
+    write(tempname)
+    os.replace(tempname, filename)
+  finally:
+    tempfiles.try_delete(tempname)
+
+
+class CompileJob:
+  """Compiles a single source file to an object file, via the object cache."""
+
+  def __init__(self, cmd, src, obj):
+    # `cmd` is the compile command, without the output file.
+    self.cmd = cmd
+    self.src = src
+    self.obj = obj
+    self.key = hashlib.sha256(json.dumps([shared.EMSCRIPTEN_VERSION, cmd, hash_file(src)]).encode()).hexdigest()
+
+  def get_depfile(self):
+    return shared.replace_suffix(self.obj, '.d')
+
+  def get_command(self):
+    return self.cmd + ['-o', self.obj, '-MD', '-MF', self.get_depfile()]
+
+  def get_cache_path(self, name):
+    return shared.Cache.get_path(os.path.join('objects', name[:2], name))
+
+  def get_cached_object(self, deps):
+    deps_hash = hashlib.sha256(json.dumps([self.key, deps]).encode()).hexdigest()
+    return self.get_cache_path(deps_hash + '.o')
+
+  def restore(self):
+    """Copies the object from the object cache if its inputs are unchanged, and returns whether it did."""
+    try:
+      deps = json.loads(utils.read_file(self.get_cache_path(self.key + '.json')))
+    except (OSError, ValueError):
+      return False
+    for dep, digest in deps:
+      if not os.path.exists(dep) or hash_file(dep) != digest:
+        return False
+    cached = self.get_cached_object(deps)
+    if not os.path.exists(cached):
+      return False
+    shutil.copyfile(cached, self.obj)
+    return True
+
+  def save(self):
+    # Assembly files may not get a depfile, but they don't include anything
+    # either.
+    depfile = self.get_depfile()
+    if os.path.exists(depfile):
+      deps = [os.path.abspath(d) for d in parse_depfile(depfile)]
+    else:
+      deps = [self.src]
+    deps = [[d, hash_file(d)] for d in deps]
+    cached = self.get_cached_object(deps)
+    utils.safe_ensure_dirs(os.path.dirname(cached))
+    # Write the object before the manifest that leads to it.
+    replace_atomically(cached, lambda f: shutil.copyfile(self.obj, f))
+    manifest = self.get_cache_path(self.key + '.json')
+    utils.safe_ensure_dirs(os.path.dirname(manifest))
+    replace_atomically(manifest, lambda f: utils.write_file(f, json.dumps(deps)))
+
+
+def run_compile_jobs(jobs):
+  """
+  Compiles the given jobs in one parallel batch, skipping any whose object is
+  up to date in the object cache.
+  """
+  ensure_sysroot()
+  num_jobs = len(jobs)
+  jobs = [job for job in jobs if not job.restore()]
+  if len(jobs) < num_jobs:
+    logger.info(f'reusing {num_jobs - len(jobs)} of {num_jobs} objects from the object cache')
+  if not jobs:
+    return
+  run_build_commands([job.get_command() for job in jobs])
+  for job in jobs:
+    job.save()
+
+
 def create_lib(libname, inputs):
   """Create a library from a set of input objects."""
   suffix = shared.suffix(libname)
@@ -309,7 +421,7 @@ class Library:
 
     This will trigger a build if this library is not in the cache.
     """
-    return shared.Cache.get_lib(self.get_filename(), self.build)
+    return shared.Cache.get_lib(self.get_filename(), self.build, atomic=True)
 
   def get_link_flag(self):
     """
@@ -343,14 +455,14 @@ class Library:
 
     raise NotImplementedError()
 
-  def build_objects(self, build_dir):
+  def get_compile_jobs(self, build_dir):
     """
-    Returns a list of compiled object files for this library.
+    Returns a list of `CompileJob`s that compile this library's object files.
 
-    By default, this builds all the source files returned by `self.get_files()`,
+    By default, this compiles all the source files returned by `self.get_files()`,
     with the `cflags` returned by `self.get_cflags()`.
     """
-    commands = []
+    jobs = []
     objects = []
     cflags = self.get_cflags()
     base_flags = get_base_cflags()
@@ -380,15 +492,26 @@ class Library:
         cmd.remove('-g')
       else:
         cmd += cflags
-      commands.append(cmd + ['-c', src, '-o', o])
+      jobs.append(CompileJob(cmd + ['-c', src], src, o))
       objects.append(o)
-    run_build_commands(commands)
-    return objects
+    return jobs
+
+  def build_objects(self, build_dir):
+    """Returns a list of compiled object files for this library."""
+    jobs = self.get_compile_jobs(build_dir)
+    run_compile_jobs(jobs)
+    return [job.obj for job in jobs]
+
+  def make_build_dir(self):
+    # Each build gets its own directory, as other processes may be building the
+    # same library at the same time.
+    build_root = shared.Cache.get_path('build')
+    utils.safe_ensure_dirs(build_root)
+    return tempfile.mkdtemp(prefix=self.get_base_name() + '.', dir=build_root)
 
   def build(self, out_filename):
     """Builds the library and returns the path to the file."""
-    build_dir = shared.Cache.get_path(os.path.join('build', self.get_base_name()))
-    utils.safe_ensure_dirs(build_dir)
+    build_dir = self.make_build_dir()
     create_lib(out_filename, self.build_objects(build_dir))
     if not shared.DEBUG:
       tempfiles.try_delete(build_dir)
@@ -801,6 +924,8 @@ class libc(AsanInstrumentedLibrary, MuslInternalLibrary, MTLibrary):
           'pthread_testcancel.c',
           'emscripten_proxy_main.c',
           'emscripten_thread_state.S',
+          'emscripten_scheduler.c',
+          'html5_event_ring.c',
         ])
     else:
       ignore += ['thread']
@@ -837,7 +962,8 @@ class libc(AsanInstrumentedLibrary, MuslInternalLibrary, MTLibrary):
         path='system/lib/pthread',
         filenames=[
           'library_pthread_stub.c',
-          'pthread_self_stub.c'
+          'pthread_self_stub.c',
+          'emscripten_scheduler.c',
         ])
 
     # These are included in wasm_libc_rt instead
@@ -890,7 +1016,7 @@ class libc(AsanInstrumentedLibrary, MuslInternalLibrary, MTLibrary):
 
     libc_files += files_in_path(
         path='system/lib/libc/musl/src/ldso',
-        filenames=['dlerror.c', 'dlsym.c', 'dlclose.c'])
+        filenames=['dlerror.c', 'dlsym.c'])
 
     libc_files += files_in_path(
         path='system/lib/libc/musl/src/linux',
@@ -926,6 +1052,7 @@ class libc(AsanInstrumentedLibrary, MuslInternalLibrary, MTLibrary):
           'extras.c',
           'wasi-helpers.c',
           'emscripten_get_heap_size.c',
+          'emscripten_snapshot.c',
           'raise.c',
           'kill.c',
           'sigaction.c',
@@ -1782,6 +1909,31 @@ def calculate(input_files, forced):
   return ret
 
 
+def build_libraries(libraries):
+  """
+  Builds the given libraries, compiling the sources of all of them in a single
+  parallel batch rather than one library after another.  Libraries that are
+  already in the cache are skipped.
+  """
+  if config.FROZEN_CACHE:
+    # Nothing can be built, leave it to get_path() to report the missing
+    # libraries.
+    return
+  libraries = [lib for lib in libraries if not os.path.exists(shared.Cache.get_path(shared.Cache.get_lib_name(lib.get_filename())))]
+  if not libraries:
+    return
+  builds = []
+  for lib in libraries:
+    build_dir = lib.make_build_dir()
+    builds.append((lib, build_dir, lib.get_compile_jobs(build_dir)))
+  run_compile_jobs([job for _, _, jobs in builds for job in jobs])
+  for lib, build_dir, jobs in builds:
+    objects = [job.obj for job in jobs]
+    shared.Cache.get_lib(lib.get_filename(), lambda out: create_lib(out, objects), atomic=True)
+    if not shared.DEBUG:
+      tempfiles.try_delete(build_dir)
+
+
 # Once we require python 3.8 we can use shutil.copytree with
 # dirs_exist_ok=True and remove this function.
 def copytree_exist_ok(src, dst):
@@ -106,10 +106,29 @@ def do_wasm2c(infile):
   ]
   for header in headers:
     total = bundle_file(total, os.path.join(header[0], header[1]))
+  # in guard page mode the generated code allocates and grows memory using the
+  # implementation in base.c instead of the one in wasm-rt-impl.c
+  total += '''\
+#ifndef WASM2C_GUARD_PAGES
+#define WASM2C_GUARD_PAGES %d
+#endif
+#if WASM2C_GUARD_PAGES
+static void wasm2c_guard_allocate_memory(wasm_rt_memory_t*, uint32_t, uint32_t);
+static uint32_t wasm2c_guard_grow_memory(wasm_rt_memory_t*, uint32_t);
+#define wasm_rt_allocate_memory wasm2c_guard_allocate_memory
+#define wasm_rt_grow_memory wasm2c_guard_grow_memory
+#endif
+''' % (settings.WASM2C_SANDBOXING == 'guard') + SEP
   # add the wasm2c output
   with open(c_file) as read_c:
     c = read_c.read()
   total += c + SEP
+  total += '''\
+#if WASM2C_GUARD_PAGES
+#undef wasm_rt_allocate_memory
+#undef wasm_rt_grow_memory
+#endif
+''' + SEP
   # add the wasm2c runtime
   total = bundle_file(total, os.path.join(WASM2C_DIR, 'wasm-rt-impl.c'))
   # add the support code
@@ -193,7 +212,7 @@ IMPORT_IMPL(%(return_type)s, Z_envZ_invoke_%(sig)sZ_%(wabt_sig)s, (%(full_typed_
   # adjust sandboxing
   TRAP_OOB = 'TRAP(OOB)'
   assert total.count(TRAP_OOB) == 2
-  if settings.WASM2C_SANDBOXING == 'full':
+  if settings.WASM2C_SANDBOXING in ('full', 'guard'):
     pass # keep it
   elif settings.WASM2C_SANDBOXING == 'none':
     total = total.replace(TRAP_OOB, '{}')
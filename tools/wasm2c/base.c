@@ -37,8 +37,13 @@ typedef signed long ssize_t;
 #define MEMACCESS(addr) ((void*)&WASM_RT_ADD_PREFIX(Z_memory)->data[addr])
 
 #undef MEMCHECK
+#if WASM2C_GUARD_PAGES
+// Out of bounds accesses fault in the guard region, see below.
+#define MEMCHECK(a, t)
+#else
 #define MEMCHECK(a, t)  \
   if (UNLIKELY((a) + sizeof(t) > WASM_RT_ADD_PREFIX(Z_memory)->size)) TRAP(OOB)
+#endif
 
 #undef DEFINE_LOAD
 #define DEFINE_LOAD(name, t1, t2, t3)              \
@@ -105,6 +110,87 @@ static void abort_with_message(const char* message) {
   TRAP(UNREACHABLE);
 }
 
+#if WASM2C_GUARD_PAGES
+
+// Guard page memory: rather than checking the bounds of every load and store,
+// reserve enough address space that any wasm address plus offset (both 32-bit)
+// lands inside the reservation, make only the pages of the current memory
+// accessible, and turn the fault on touching any other page into a trap.
+
+#if UINTPTR_MAX != 0xffffffffffffffff || defined(_WIN32)
+#error "WASM2C_GUARD_PAGES requires a 64-bit POSIX system"
+#endif
+
+#include <signal.h>
+#include <sys/mman.h>
+
+#define GUARD_PAGE_SIZE 65536
+#define GUARD_RESERVATION_SIZE (8ull << 30)
+
+static char* guard_memory_base;
+
+static void guard_signal_handler(int sig, siginfo_t* info, void* context) {
+  char* addr = (char*)info->si_addr;
+  if (guard_memory_base && addr >= guard_memory_base &&
+      addr < guard_memory_base + GUARD_RESERVATION_SIZE) {
+    // The handler is installed with SA_NODEFER, so it is fine to jump out of
+    // it.
+    wasm_rt_trap(WASM_RT_TRAP_OOB);
+  }
+  // Not a wasm memory access: crash as we would have without the handler.
+  signal(sig, SIG_DFL);
+}
+
+static void wasm2c_guard_allocate_memory(wasm_rt_memory_t* memory, uint32_t initial_pages, uint32_t max_pages) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = guard_signal_handler;
+  sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+  sigemptyset(&sa.sa_mask);
+  // macOS reports accesses to PROT_NONE pages as SIGBUS.
+  if (sigaction(SIGSEGV, &sa, NULL) != 0 || sigaction(SIGBUS, &sa, NULL) != 0) {
+    perror("sigaction failed");
+    abort();
+  }
+
+  void* data = mmap(NULL, GUARD_RESERVATION_SIZE, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (data == MAP_FAILED) {
+    perror("mmap failed");
+    abort();
+  }
+  size_t byte_length = (size_t)initial_pages * GUARD_PAGE_SIZE;
+  if (byte_length && mprotect(data, byte_length, PROT_READ | PROT_WRITE) != 0) {
+    perror("mprotect failed");
+    abort();
+  }
+  guard_memory_base = data;
+  memory->data = data;
+  memory->pages = initial_pages;
+  memory->max_pages = max_pages;
+  memory->size = byte_length;
+}
+
+static uint32_t wasm2c_guard_grow_memory(wasm_rt_memory_t* memory, uint32_t delta) {
+  uint32_t old_pages = memory->pages;
+  uint32_t new_pages = old_pages + delta;
+  if (new_pages < old_pages || new_pages > memory->max_pages) {
+    return (uint32_t)-1;
+  }
+  // Freshly reserved pages are already zero, so making them accessible is all
+  // that growing takes; the memory never moves.
+  size_t old_length = (size_t)old_pages * GUARD_PAGE_SIZE;
+  if (delta && mprotect(memory->data + old_length, (size_t)delta * GUARD_PAGE_SIZE,
+                        PROT_READ | PROT_WRITE) != 0) {
+    return (uint32_t)-1;
+  }
+  memory->pages = new_pages;
+  memory->size = (size_t)new_pages * GUARD_PAGE_SIZE;
+  return old_pages;
+}
+
+#endif // WASM2C_GUARD_PAGES
+
 // Maintain a stack of setjmps, each jump taking us back to the last invoke.
 
 #define MAX_SETJMP_STACK 1024
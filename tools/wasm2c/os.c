@@ -132,6 +132,100 @@ IMPORT_IMPL(u32, Z_wasi_snapshot_preview1Z_fd_readZ_iiiii, (u32 fd, u32 iov, u32
   return 0;
 });
 
+#define WASI_EFAULT 21
+
+static ssize_t read_at(int nfd, void* buf, size_t len, u64 pos) {
+#ifndef _WIN32
+  return pread(nfd, buf, len, pos);
+#else
+  if (_lseeki64(nfd, pos, SEEK_SET) < 0) {
+    return -1;
+  }
+  return read(nfd, buf, len);
+#endif
+}
+
+#if WASM2C_GUARD_PAGES
+// Linear memory is made of ordinary anonymous pages, so a read of a file into
+// it can instead map the file over the destination, copy-on-write, and let the
+// OS page it in as it is touched.  Returns the number of bytes mapped, which is
+// a whole number of host pages, or 0 if the read isn't suitably aligned.
+static size_t map_file_into_memory(int nfd, u32 ptr, u32 len, u64 pos) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  char* dest = MEMACCESS(ptr);
+  if (((uintptr_t)dest | pos) & (page_size - 1)) {
+    return 0;
+  }
+  // Pages past the end of the file can't be mapped.
+  struct stat st;
+  if (fstat(nfd, &st) != 0 || !S_ISREG(st.st_mode) || (u64)st.st_size <= pos) {
+    return 0;
+  }
+  u64 available = st.st_size - pos;
+  size_t length = (len < available ? len : available) & ~(page_size - 1);
+  if (length == 0 ||
+      mmap(dest, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, nfd, pos) == MAP_FAILED) {
+    return 0;
+  }
+  VERBOSE_LOG("    mapped %zu bytes\n", length);
+  return length;
+}
+#endif
+
+IMPORT_IMPL(u32, Z_wasi_snapshot_preview1Z_fd_preadZ_iiiiji, (u32 fd, u32 iov, u32 iovcnt, u64 offset, u32 pnum), {
+  int nfd = get_native_fd(fd);
+  VERBOSE_LOG("  fd_pread wasm %d => native %d\n", fd, nfd);
+  if (nfd < 0) {
+    return WASI_DEFAULT_ERROR;
+  }
+  u32 num = 0;
+  for (u32 i = 0; i < iovcnt; i++) {
+    u32 ptr = wasm_i32_load(iov + i * 8);
+    u32 len = wasm_i32_load(iov + i * 8 + 4);
+    VERBOSE_LOG("    chunk %d %d\n", ptr, len);
+    if ((u64)ptr + len > WASM_RT_ADD_PREFIX(Z_memory)->size) {
+      return WASI_EFAULT;
+    }
+    size_t done = 0;
+#if WASM2C_GUARD_PAGES
+    done = map_file_into_memory(nfd, ptr, len, offset + num);
+#endif
+    if (done < len) {
+      ssize_t result = read_at(nfd, MEMACCESS(ptr + done), len - done, offset + num + done);
+      if (result < 0) {
+        VERBOSE_LOG("    error, %d %s\n", errno, strerror(errno));
+        return WASI_DEFAULT_ERROR;
+      }
+      done += result;
+    }
+    num += done;
+    if (done != len) {
+      break; // nothing more to read
+    }
+  }
+  VERBOSE_LOG("    success: %d\n", num);
+  wasm_i32_store(pnum, num);
+  return 0;
+});
+
+// Called by munmap() for a file mapping that fd_pread may have filled.
+IMPORT_IMPL(void, Z_envZ__emscripten_notify_munmapZ_vii, (u32 addr, u32 len), {
+#if WASM2C_GUARD_PAGES
+  // Replace any pages of the file mapped there with anonymous ones, so that
+  // memory malloc hands out later is not backed by the file, which may since
+  // have been truncated.
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t length = len & ~(page_size - 1);
+  if (((uintptr_t)MEMACCESS(addr) & (page_size - 1)) ||
+      (u64)addr + len > WASM_RT_ADD_PREFIX(Z_memory)->size || length == 0) {
+    return;
+  }
+  if (mmap(MEMACCESS(addr), length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+    abort_with_message("failed to unmap a file from memory");
+  }
+#endif
+});
+
 IMPORT_IMPL(u32, Z_wasi_snapshot_preview1Z_fd_closeZ_ii, (u32 fd), {
   // TODO full file support
   int nfd = get_native_fd(fd);
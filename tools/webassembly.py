@@ -8,6 +8,7 @@
 
 from collections import namedtuple
 from enum import IntEnum
+import io
 import logging
 import os
 import sys
@@ -238,6 +239,50 @@ class Module:
     return imports
 
 
+def replace_data_segments(wasm_file, segments):
+  """Replaces the data segments of the given wasm file with active segments
+  for memory 0, given as a list of (offset, bytes) pairs."""
+  module = Module(wasm_file)
+  sections = list(module.sections())
+  del module
+  data = utils.read_binary(wasm_file)
+
+  def make_section(section_type, payload):
+    return bytes([section_type]) + toLEB(len(payload)) + payload
+
+  data_payload = toLEB(len(segments))
+  for offset, contents in segments:
+    # flags (active, memory 0), i32.const offset, end, contents
+    data_payload += b'\0\x41' + leb128.i.encode(offset) + b'\x0b' + toLEB(len(contents)) + contents
+  data_section = make_section(SecType.DATA, data_payload)
+
+  # If there is no data section yet, it goes after the last non-custom section.
+  if any(s.type == SecType.DATA for s in sections):
+    insert_after = None
+  else:
+    insert_after = [s for s in sections if s.type != SecType.CUSTOM][-1]
+
+  output = [data[:HEADER_SIZE]]
+  start = HEADER_SIZE
+  for section in sections:
+    end = section.offset + section.size
+    if section.type == SecType.DATA:
+      segment_count = readULEB(io.BytesIO(data[section.offset:end]))
+      flags = data[section.offset + len(toLEB(segment_count))]
+      # Passive segments are copied in by code (e.g. for pthreads), which would
+      # need rewriting too.
+      assert segment_count == 0 or flags == 0, 'replace_data_segments: only active segments are supported'
+      output.append(data_section)
+    elif section.type == SecType.DATACOUNT:
+      output.append(make_section(SecType.DATACOUNT, toLEB(len(segments))))
+    else:
+      output.append(data[start:end])
+      if section == insert_after:
+        output.append(data_section)
+    start = end
+  utils.write_binary(wasm_file, b''.join(output))
+
+
 def parse_dylink_section(wasm_file):
   module = Module(wasm_file)
   return module.parse_dylink_section()
@@ -20,6 +20,7 @@ int CHECKED_TRUNCATE_TO_POSITIVE_INT32(const T &val)
 #include <unistd.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 
 #define SOCKET_T int
 #define SHUTDOWN_READ SHUT_RD
@@ -29,6 +30,8 @@ int CHECKED_TRUNCATE_TO_POSITIVE_INT32(const T &val)
 #define SEND_RET_TYPE ssize_t
 #define SEND_FORMATTING_SPECIFIER "%ld"
 #define CLOSE_SOCKET(x) close(x)
+#define POLLFD_T struct pollfd
+#define POLL(fds, nfds, timeout) poll((fds), (nfds), (timeout))
 
 #define GET_SOCKET_ERROR() (errno)
 
@@ -49,6 +52,8 @@ int CHECKED_TRUNCATE_TO_POSITIVE_INT32(const T &val)
 #define SEND_RET_TYPE int
 #define SEND_FORMATTING_SPECIFIER "%d"
 #define CLOSE_SOCKET(x) closesocket(x)
+#define POLLFD_T WSAPOLLFD
+#define POLL(fds, nfds, timeout) WSAPoll((fds), (nfds), (timeout))
 
 #define GET_SOCKET_ERROR() (WSAGetLastError())
 
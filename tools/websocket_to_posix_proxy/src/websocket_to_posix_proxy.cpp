@@ -43,6 +43,7 @@ uint64_t ntoh64(uint64_t x) // thread-safe, re-entrant
 #define POSIX_SOCKET_MSG_SETSOCKOPT 17
 #define POSIX_SOCKET_MSG_GETADDRINFO 18
 #define POSIX_SOCKET_MSG_GETNAMEINFO 19
+#define POSIX_SOCKET_MSG_POLL 20
 
 #define MAX_SOCKADDR_SIZE 256
 #define MAX_OPTIONVALUE_SIZE 16
@@ -1256,7 +1257,7 @@ void Sendto(int client_fd, uint8_t *data, uint64_t numBytes) // ssize_t/int send
 
   if (IsSocketPartOfConnection(client_fd, d->socket))
   {
-    ret = sendto(d->socket, (const char *)d->message, d->length, d->flags, (sockaddr*)d->dest_addr, d->dest_len);
+    ret = sendto(d->socket, (const char *)d->message, d->length, d->flags, d->dest_len ? (sockaddr*)d->dest_addr : 0, d->dest_len);
     errorCode = (ret != 0) ? GET_SOCKET_ERROR() : 0;
 
 #ifdef POSIX_SOCKET_DEBUG
@@ -1340,22 +1341,16 @@ void Recvfrom(int client_fd, uint8_t *data, uint64_t numBytes) // ssize_t/int re
   free(r);
 }
 
+// The client gathers/scatters the data of sendmsg() and recvmsg() calls on its side, and serializes them with the same
+// message layouts as sendto() and recvfrom(). (ancillary data is not supported)
 void Sendmsg(int client_fd, uint8_t *data, uint64_t numBytes) // ssize_t/int sendmsg(int socket, const struct msghdr *message, int flags);
 {
-	printf("TODO implement sendmsg()\n");
-#ifdef POSIX_SOCKET_DEBUG
-//  printf("sendmsg(socket=%d,message=%p,flags=%d)\n", d->socket, d->message, d->flags);
-#endif
-
-  // TODO
+  Sendto(client_fd, data, numBytes);
 }
 
 void Recvmsg(int client_fd, uint8_t *data, uint64_t numBytes) // ssize_t/int recvmsg(int socket, struct msghdr *message, int flags);
 {
-	printf("TODO implement recvmsg()\n");
-#ifdef POSIX_SOCKET_DEBUG
-//  printf("recvmsg(socket=%d,message=%p,flags=%d)\n", d->socket, d->message, d->flags);
-#endif
+  Recvfrom(client_fd, data, numBytes);
 }
 
 void Getsockopt(int client_fd, uint8_t *data, uint64_t numBytes) // int getsockopt(int socket, int level, int option_name, void *option_value, socklen_t *option_len);
@@ -1576,6 +1571,102 @@ void Getnameinfo(int client_fd, uint8_t *data, uint64_t numBytes) // int getname
   fprintf(stderr, "TODO getnameinfo() unimplemented!\n");
 }
 
+#define MUSL_POLLIN 0x001
+#define MUSL_POLLPRI 0x002
+#define MUSL_POLLOUT 0x004
+#define MUSL_POLLERR 0x008
+#define MUSL_POLLHUP 0x010
+#define MUSL_POLLNVAL 0x020
+
+static short Translate_Poll_Events_To_Native(short events)
+{
+#if defined(_MSC_VER)
+  // WSAPoll() does not accept POLLPRI, and rejects POLLERR/POLLHUP/POLLNVAL in events.
+  short ret = 0;
+  if (events & MUSL_POLLIN) ret |= POLLRDNORM;
+  if (events & MUSL_POLLOUT) ret |= POLLWRNORM;
+  return ret;
+#else
+  // Linux and macOS use the same values as musl.
+  return events;
+#endif
+}
+
+static short Translate_Poll_Events_From_Native(short revents)
+{
+#if defined(_MSC_VER)
+  short ret = 0;
+  if (revents & (POLLRDNORM | POLLRDBAND)) ret |= MUSL_POLLIN;
+  if (revents & POLLPRI) ret |= MUSL_POLLPRI;
+  if (revents & POLLWRNORM) ret |= MUSL_POLLOUT;
+  if (revents & POLLERR) ret |= MUSL_POLLERR;
+  if (revents & POLLHUP) ret |= MUSL_POLLHUP;
+  if (revents & POLLNVAL) ret |= MUSL_POLLNVAL;
+  return ret;
+#else
+  return revents;
+#endif
+}
+
+void Poll(int client_fd, uint8_t *data, uint64_t numBytes) // int poll(struct pollfd *fds, nfds_t nfds, int timeout);
+{
+  struct PollFd {
+    int fd;
+    short events;
+    short revents;
+  };
+  struct MSG {
+    SocketCallHeader header;
+    int timeout;
+    uint32_t nfds;
+    PollFd fds[];
+  };
+  MSG *d = (MSG*)data;
+
+  uint32_t nfds = MIN(d->nfds, (uint32_t)((numBytes - sizeof(MSG)) / sizeof(PollFd)));
+  POLLFD_T *fds = (POLLFD_T*)malloc(MAX(nfds, 1) * sizeof(POLLFD_T));
+  int numInvalid = 0;
+  for(uint32_t i = 0; i < nfds; ++i)
+  {
+    // Sockets that this proxy client did not create are reported back as POLLNVAL without being passed to the OS.
+    bool valid = d->fds[i].fd >= 0 && IsSocketPartOfConnection(client_fd, d->fds[i].fd);
+    if (!valid && d->fds[i].fd >= 0) ++numInvalid;
+    fds[i].fd = valid ? d->fds[i].fd : (SOCKET_T)-1;
+    fds[i].events = Translate_Poll_Events_To_Native(d->fds[i].events);
+    fds[i].revents = 0;
+  }
+
+  int ret = POLL(fds, nfds, d->timeout);
+  int errorCode = (ret < 0) ? GET_SOCKET_ERROR() : 0;
+#ifdef POSIX_SOCKET_DEBUG
+  printf("poll(fds=%p,nfds=%u,timeout=%d)->%d\n", fds, nfds, d->timeout, ret);
+  if (errorCode) PRINT_SOCKET_ERROR(errorCode);
+#endif
+
+  struct Result {
+    int callId;
+    int ret;
+    int errno_;
+    PollFd fds[];
+  };
+  int resultSize = sizeof(Result) + nfds * sizeof(PollFd);
+  Result *r = (Result *)malloc(resultSize);
+  r->callId = d->header.callId;
+  r->ret = (ret >= 0) ? ret + numInvalid : ret;
+  r->errno_ = errorCode;
+  for(uint32_t i = 0; i < nfds; ++i)
+  {
+    r->fds[i].fd = d->fds[i].fd;
+    r->fds[i].events = d->fds[i].events;
+    if (d->fds[i].fd < 0) r->fds[i].revents = 0;
+    else if (fds[i].fd == (SOCKET_T)-1) r->fds[i].revents = MUSL_POLLNVAL;
+    else r->fds[i].revents = (ret > 0) ? Translate_Poll_Events_From_Native(fds[i].revents) : 0;
+  }
+  free(fds);
+  SendWebSocketMessage(client_fd, r, resultSize);
+  free(r);
+}
+
 static void *memdup(const void *ptr, size_t sz)
 {
   if (!ptr) return 0;
@@ -1642,6 +1733,7 @@ void ProcessWebSocketMessageSynchronouslyInCurrentThread(int client_fd, uint8_t
     case POSIX_SOCKET_MSG_SETSOCKOPT: Setsockopt(client_fd, payload, numBytes); break;
     case POSIX_SOCKET_MSG_GETADDRINFO: Getaddrinfo(client_fd, payload, numBytes); break;
     case POSIX_SOCKET_MSG_GETNAMEINFO: Getnameinfo(client_fd, payload, numBytes); break;
+    case POSIX_SOCKET_MSG_POLL: Poll(client_fd, payload, numBytes); break;
     default:
       printf("Unknown POSIX_SOCKET_MSG %u received!\n", header->function);
       break;
@@ -1656,7 +1748,7 @@ void ProcessWebSocketMessage(int client_fd, uint8_t *payload, uint64_t numBytes)
     return;
   }
   SocketCallHeader *header = (SocketCallHeader*)payload;
-  if (header->function == POSIX_SOCKET_MSG_RECV || header->function == POSIX_SOCKET_MSG_RECVFROM || header->function == POSIX_SOCKET_MSG_RECVMSG || header->function == POSIX_SOCKET_MSG_CONNECT || header->function == POSIX_SOCKET_MSG_ACCEPT)
+  if (header->function == POSIX_SOCKET_MSG_RECV || header->function == POSIX_SOCKET_MSG_RECVFROM || header->function == POSIX_SOCKET_MSG_RECVMSG || header->function == POSIX_SOCKET_MSG_CONNECT || header->function == POSIX_SOCKET_MSG_ACCEPT || header->function == POSIX_SOCKET_MSG_POLL)
   {
     // Synchonous/blocking recv()s can halt indefinitely until a message is actually received. An application might
     // be send()ing messages in one thread while using another thread to wait for recv(). Therefore run these potentially